@@ -0,0 +1,285 @@
+/*
+# Code for the cross-call cache of sort buffers
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+#include <Rcpp.h>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "buffer_cache.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#define BUFFER_CACHE_MMAP 1
+#endif
+
+using namespace Rcpp;
+
+namespace {
+
+// Size classes start at one page, from 2 MiB on buffers are mmapped in multiples of 2 MiB
+// (huge page size on x86)
+const size_t BUFFER_MIN_BYTES = 4096;
+const size_t BUFFER_MMAP_BYTES = 2u << 20;
+const size_t BUFFER_ALIGN = 64;
+
+struct buffer_cache {
+  std::mutex lock;
+  std::multimap<size_t, void*> cached;  // capacity -> buffer
+  size_t cached_bytes = 0;
+  size_t limit_bytes = size_t(256) << 20;
+  int policy = GREENSORT_ALLOC_DEFAULT;
+  double hits = 0;
+  double misses = 0;
+  double alloc_secs = 0;
+  double hugetlb_fallbacks = 0;
+};
+
+buffer_cache& cache() {
+  static buffer_cache c;
+  return c;
+}
+
+// Rounds up to four classes per power of two
+size_t buffer_size_class(size_t bytes) {
+  if (bytes <= BUFFER_MIN_BYTES)
+    return BUFFER_MIN_BYTES;
+  size_t base = BUFFER_MIN_BYTES;
+  while (base * 2 < bytes)
+    base *= 2;
+  size_t quarter = base / 4;
+  size_t cls = base + (bytes - base + quarter - 1) / quarter * quarter;
+  if (cls >= BUFFER_MMAP_BYTES)
+    cls = (cls + BUFFER_MMAP_BYTES - 1) / BUFFER_MMAP_BYTES * BUFFER_MMAP_BYTES;
+  return cls;
+}
+
+void* buffer_alloc(buffer_cache& c, size_t capacity) {
+#ifdef BUFFER_CACHE_MMAP
+  if (capacity >= BUFFER_MMAP_BYTES) {
+    int policy;
+    {
+      std::lock_guard<std::mutex> guard(c.lock);
+      policy = c.policy;
+    }
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (policy == GREENSORT_ALLOC_HUGETLB) {
+      p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+      if (p != MAP_FAILED)
+        return p;
+    }
+#endif
+    if (policy == GREENSORT_ALLOC_HUGETLB) {
+      // no (or not enough) huge pages reserved in hugetlbfs
+      std::lock_guard<std::mutex> guard(c.lock);
+      c.hugetlb_fallbacks++;
+    }
+#ifdef MAP_POPULATE
+    if (policy == GREENSORT_ALLOC_POPULATE)
+      flags |= MAP_POPULATE;
+#endif
+    p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED)
+      throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (policy == GREENSORT_ALLOC_HUGEPAGE)
+      madvise(p, capacity, MADV_HUGEPAGE);
+#endif
+    return p;
+  }
+#endif
+  (void) c;
+  void* p = std::aligned_alloc(BUFFER_ALIGN, capacity);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void buffer_free(void* p, size_t capacity) {
+#ifdef BUFFER_CACHE_MMAP
+  if (capacity >= BUFFER_MMAP_BYTES) {
+    munmap(p, capacity);
+    return;
+  }
+#endif
+  (void) capacity;
+  std::free(p);
+}
+
+// Frees cached buffers (largest first) until at most limit bytes are cached
+void buffer_evict(buffer_cache& c, size_t limit) {
+  std::vector<std::pair<size_t, void*>> evicted;
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    while (c.cached_bytes > limit && !c.cached.empty()) {
+      auto it = std::prev(c.cached.end());
+      evicted.push_back(*it);
+      c.cached_bytes -= it->first;
+      c.cached.erase(it);
+    }
+  }
+  for (auto& e : evicted)
+    buffer_free(e.second, e.first);
+}
+
+}
+
+
+void* GreensortBufferAcquire(size_t bytes, size_t* capacity) {
+  buffer_cache& c = cache();
+  size_t cls = buffer_size_class(bytes);
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    // Accept a cached buffer of up to twice the needed class
+    auto it = c.cached.lower_bound(cls);
+    if (it != c.cached.end() && it->first <= 2 * cls) {
+      void* p = it->second;
+      *capacity = it->first;
+      c.cached_bytes -= it->first;
+      c.cached.erase(it);
+      c.hits++;
+      return p;
+    }
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  void* p = buffer_alloc(c, cls);
+  auto stop = std::chrono::high_resolution_clock::now();
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    c.misses++;
+    c.alloc_secs += std::chrono::duration <double, std::ratio<1,1>> (stop - start).count();
+  }
+  *capacity = cls;
+  return p;
+}
+
+void GreensortBufferRelease(void* p, size_t capacity) {
+  buffer_cache& c = cache();
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    if (c.cached_bytes + capacity <= c.limit_bytes) {
+      c.cached.insert(std::make_pair(capacity, p));
+      c.cached_bytes += capacity;
+      return;
+    }
+  }
+  buffer_free(p, capacity);
+}
+
+double GreensortBufferAllocSecs() {
+  buffer_cache& c = cache();
+  std::lock_guard<std::mutex> guard(c.lock);
+  return c.alloc_secs;
+}
+
+void* GreensortBufferAllocate(size_t bytes, size_t* capacity) {
+  size_t cls = buffer_size_class(bytes);
+  void* p = buffer_alloc(cache(), cls);
+  *capacity = cls;
+  return p;
+}
+
+void GreensortBufferFree(void* p, size_t capacity) {
+  buffer_free(p, capacity);
+}
+
+double GreensortPageFaults() {
+#ifdef BUFFER_CACHE_MMAP
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return (double) usage.ru_minflt + (double) usage.ru_majflt;
+#endif
+  return NA_REAL;
+}
+
+
+// [[Rcpp::export]]
+double BufferCache_warm(double bytes, int count) {
+  buffer_cache& c = cache();
+  size_t cls = buffer_size_class(bytes);
+  std::vector<std::pair<void*, size_t>> warm;
+  for (int i = 0; i < count; i++) {
+    {
+      std::lock_guard<std::mutex> guard(c.lock);
+      if (c.cached_bytes + (warm.size() + 1) * cls > c.limit_bytes)
+        break;
+    }
+    size_t capacity;
+    void* p = GreensortBufferAcquire(cls, &capacity);
+    std::memset(p, 0, capacity);  // pre-fault the pages
+    warm.push_back(std::make_pair(p, capacity));
+  }
+  double warmed = 0;
+  for (auto& w : warm) {
+    GreensortBufferRelease(w.first, w.second);
+    warmed += w.second;
+  }
+  return warmed;
+}
+
+// [[Rcpp::export]]
+double BufferCache_limit(double limit) {
+  buffer_cache& c = cache();
+  double old_limit;
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    old_limit = c.limit_bytes;
+    if (!ISNAN(limit))
+      c.limit_bytes = limit;
+  }
+  if (!ISNAN(limit))
+    buffer_evict(c, limit);
+  return old_limit;
+}
+
+// [[Rcpp::export]]
+int BufferCache_policy(int policy) {
+  buffer_cache& c = cache();
+  int old_policy;
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    old_policy = c.policy;
+    if (policy != NA_INTEGER)
+      c.policy = policy;
+  }
+  // cached buffers were allocated under the old policy
+  if (policy != NA_INTEGER && policy != old_policy)
+    buffer_evict(c, 0);
+  return old_policy;
+}
+
+// [[Rcpp::export]]
+double BufferCache_release() {
+  buffer_cache& c = cache();
+  double released;
+  {
+    std::lock_guard<std::mutex> guard(c.lock);
+    released = c.cached_bytes;
+  }
+  buffer_evict(c, 0);
+  return released;
+}
+
+// [[Rcpp::export]]
+List BufferCache_info() {
+  buffer_cache& c = cache();
+  std::lock_guard<std::mutex> guard(c.lock);
+  return List::create(
+    Named("limit") = (double) c.limit_bytes
+  , Named("cached") = (double) c.cached_bytes
+  , Named("buffers") = (double) c.cached.size()
+  , Named("policy") = c.policy
+  , Named("hits") = c.hits
+  , Named("misses") = c.misses
+  , Named("alloc_secs") = c.alloc_secs
+  , Named("hugetlb_fallbacks") = c.hugetlb_fallbacks
+  );
+}
@@ -0,0 +1,651 @@
+/*
+# Code for the external memory sort of binary files larger than RAM
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ Extsort sorts a binary file of doubles, integers or int64 (native byte order like writeBin)
+ into another binary file within a memory budget, in three phases:
+
+ runs   the input is read in chunks of about the budget, NA are set aside into a temporary
+        file, each chunk is sorted in memory by the engine (unless already sorted) and appended
+        to the current run if it continues it, else it starts a new run. Each run is a temporary
+        file, presorted input gives fewer and longer (natural) runs.
+ merge  the runs are merged k-way (k = fanin) in the order of multiway powersort (Gelling,
+        Nebel, Smith & Wild 2023): the power of the boundary between neighbouring runs is the
+        first base k digit in which the midpoints of the runs (relative to n) differ. A run stays
+        on the stack until a boundary of lower power arrives, then the runs of the top power (at
+        most k-1) are merged with it. Runs of very different length hence merge like the leaves
+        of a balanced k-ary tree over their positions.
+ final  the last merge of the at most k remaining runs writes the output file, with the NA
+        before or after the values.
+
+ All I/O goes through blocks of budget/(2k+2) bytes (at least 64 KiB). Reads and writes are
+ double buffered: an asynchronous task reads (writes) the next block while the current one is
+ merged, and the input is read with POSIX_FADV_SEQUENTIAL read-ahead. With direct the temporary
+ files and the output are written with O_DIRECT (page cache bypassed, where supported) instead of
+ large sequential buffered writes. Temporary files are unlinked right after their creation and
+ vanish with their descriptors. The output may be the input file, it is opened after all input
+ has been read.
+*/
+
+#include <Rcpp.h>
+#include "ips4o/ips4o.hpp"
+#include "pdq/pdqsort.h"
+#include "pdq/pdqsort_parallel.h"
+#include "ska/ska_sort.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+enum Extsort_engine {
+  EXTSORT_IPS4O = 0
+, EXTSORT_IS4O = 1
+, EXTSORT_PPDQSORT = 2
+, EXTSORT_PDQSORT = 3
+, EXTSORT_SKASORT = 4
+};
+
+static const size_t Extsort_align = 4096;
+
+// Bytes read and written by the readers and writers (also from their asynchronous tasks)
+struct Extsort_io {
+  std::atomic<std::uint64_t> read{0};
+  std::atomic<std::uint64_t> written{0};
+};
+
+static std::runtime_error Extsort_error(const std::string& what) {
+  return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// Switches O_DIRECT on or off, returns whether that succeeded (not supported by all file systems)
+static bool Extsort_direct(int fd, bool on) {
+#ifdef O_DIRECT
+  int flags = fcntl(fd, F_GETFL);
+  if (flags < 0)
+    return false;
+  return fcntl(fd, F_SETFL, on ? flags | O_DIRECT : flags & ~O_DIRECT) == 0;
+#else
+  return !on;
+#endif
+}
+
+static size_t Extsort_pread(int fd, char* buf, size_t bytes, std::uint64_t pos) {
+  size_t got = 0;
+  while (got < bytes){
+    ssize_t r = pread(fd, buf + got, bytes - got, (off_t) (pos + got));
+    if (r < 0){
+      if (errno == EINTR)
+        continue;
+      throw Extsort_error("cannot read");
+    }
+    if (r == 0)
+      break;
+    got += r;
+  }
+  return got;
+}
+
+static void Extsort_pwrite(int fd, const char* buf, size_t bytes, std::uint64_t pos) {
+  size_t put = 0;
+  while (put < bytes){
+    ssize_t r = pwrite(fd, buf + put, bytes - put, (off_t) (pos + put));
+    if (r < 0){
+      if (errno == EINTR)
+        continue;
+      throw Extsort_error("cannot write");
+    }
+    put += r;
+  }
+}
+
+// Memory of one I/O block aligned for O_DIRECT
+class Extsort_block {
+public:
+  explicit Extsort_block(size_t bytes) : p_(static_cast<char*>(std::aligned_alloc(Extsort_align, bytes))) {
+    if (!p_)
+      throw std::bad_alloc();
+  }
+  Extsort_block(const Extsort_block&) = delete;
+  Extsort_block& operator=(const Extsort_block&) = delete;
+  ~Extsort_block() { std::free(p_); }
+  char* data() const { return p_; }
+private:
+  char* p_;
+};
+
+// An open file: a temporary file (unlinked at once) or the input or output file
+class Extsort_file {
+public:
+  // a temporary file in dir
+  Extsort_file(const std::string& dir, bool direct) : bytes(0) {
+    std::string path = dir + "/greensort_extsort_XXXXXX";
+    std::vector<char> p(path.begin(), path.end());
+    p.push_back('\0');
+    fd = mkstemp(p.data());
+    if (fd < 0)
+      throw Extsort_error("cannot create a temporary file in '" + dir + "'");
+    unlink(p.data());
+    this->direct = direct && Extsort_direct(fd, true);
+  }
+  Extsort_file(const std::string& path, int flags, bool direct) : bytes(0) {
+    fd = open(path.c_str(), flags, 0666);
+    if (fd < 0)
+      throw Extsort_error("cannot open '" + path + "'");
+    this->direct = direct && Extsort_direct(fd, true);
+  }
+  Extsort_file(const Extsort_file&) = delete;
+  Extsort_file& operator=(const Extsort_file&) = delete;
+  ~Extsort_file() { close(fd); }
+  int fd;
+  bool direct;
+  std::uint64_t bytes;
+};
+
+// Sequential double buffered reader of the first bytes of a file
+template<class T>
+class Extsort_reader {
+public:
+  Extsort_reader(const Extsort_file& f, std::uint64_t bytes, size_t block, Extsort_io* io)
+  : fd_(f.fd), pos_(0), end_(bytes), block_(block), io_(io), buf0_(block), buf1_(block), k_(0), cur_(nullptr), i_(0), n_(0) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    next_ = std::async(std::launch::async, [this]{ return fill(buf0_.data()); });
+    advance();
+  }
+  Extsort_reader(const Extsort_reader&) = delete;
+  Extsort_reader& operator=(const Extsort_reader&) = delete;
+  ~Extsort_reader() {
+    if (next_.valid())
+      next_.wait();
+  }
+  bool empty() const { return i_ == n_; }
+  T head() const { return cur_[i_]; }
+  void pop() {
+    if (++i_ == n_)
+      advance();
+  }
+  // Copies up to m elements to dst, returns the number copied
+  size_t read(T* dst, size_t m) {
+    size_t c = 0;
+    while (c < m && !empty()){
+      size_t l = std::min(m - c, n_ - i_);
+      std::memcpy(dst + c, cur_ + i_, l * sizeof(T));
+      c += l;
+      i_ += l;
+      if (i_ == n_)
+        advance();
+    }
+    return c;
+  }
+  // The rest of the current block (for copying it as a whole)
+  const T* rest(size_t* m) const {
+    *m = n_ - i_;
+    return cur_ + i_;
+  }
+  void skip() {
+    i_ = n_;
+    advance();
+  }
+private:
+  // reads the next block into buf, only one task is pending at any time
+  size_t fill(char* buf) {
+    size_t want = (size_t) std::min((std::uint64_t) block_, end_ - pos_);
+    size_t got = want ? std::min(Extsort_pread(fd_, buf, block_, pos_), want) : 0;
+    pos_ += got;
+    io_->read += got;
+    return got / sizeof(T);
+  }
+  // waits for the pending block, makes it current and starts reading into the other block
+  void advance() {
+    n_ = next_.valid() ? next_.get() : 0;
+    cur_ = reinterpret_cast<T*>(k_ ? buf1_.data() : buf0_.data());
+    i_ = 0;
+    k_ ^= 1;
+    if (n_ && pos_ < end_){
+      char* buf = k_ ? buf1_.data() : buf0_.data();
+      next_ = std::async(std::launch::async, [this, buf]{ return fill(buf); });
+    }
+  }
+  int fd_;
+  std::uint64_t pos_, end_;
+  size_t block_;
+  Extsort_io* io_;
+  Extsort_block buf0_, buf1_;
+  int k_;
+  T* cur_;
+  size_t i_, n_;
+  std::future<size_t> next_;
+};
+
+// Sequential double buffered writer appending to a file
+template<class T>
+class Extsort_writer {
+public:
+  Extsort_writer(Extsort_file& f, size_t block, Extsort_io* io)
+  : f_(f), m_(block / sizeof(T)), io_(io), buf0_(block), buf1_(block), k_(0), i_(0) {
+    cur_ = reinterpret_cast<T*>(buf0_.data());
+  }
+  Extsort_writer(const Extsort_writer&) = delete;
+  Extsort_writer& operator=(const Extsort_writer&) = delete;
+  ~Extsort_writer() {
+    if (pending_.valid())
+      pending_.wait();
+  }
+  void push(T v) {
+    cur_[i_++] = v;
+    if (i_ == m_)
+      flush();
+  }
+  void write(const T* src, size_t n) {
+    while (n){
+      size_t l = std::min(n, m_ - i_);
+      std::memcpy(cur_ + i_, src, l * sizeof(T));
+      i_ += l;
+      src += l;
+      n -= l;
+      if (i_ == m_)
+        flush();
+    }
+  }
+  // Writes the tail and waits until all is written
+  void finish() {
+    flush();
+    if (pending_.valid())
+      pending_.get();
+  }
+private:
+  void flush() {
+    if (!i_)
+      return;
+    if (pending_.valid())
+      pending_.get();
+    size_t bytes = i_ * sizeof(T);
+    // O_DIRECT writes whole aligned blocks only, the tail is written through the page cache
+    if (f_.direct && bytes % Extsort_align){
+      Extsort_direct(f_.fd, false);
+      f_.direct = false;
+    }
+    const char* buf = reinterpret_cast<const char*>(cur_);
+    std::uint64_t pos = f_.bytes;
+    int fd = f_.fd;
+    Extsort_io* io = io_;
+    pending_ = std::async(std::launch::async, [fd, buf, bytes, pos, io]{
+      Extsort_pwrite(fd, buf, bytes, pos);
+      io->written += bytes;
+    });
+    f_.bytes += bytes;
+    k_ ^= 1;
+    cur_ = reinterpret_cast<T*>(k_ ? buf1_.data() : buf0_.data());
+    i_ = 0;
+  }
+  Extsort_file& f_;
+  size_t m_;
+  Extsort_io* io_;
+  Extsort_block buf0_, buf1_;
+  int k_;
+  T* cur_;
+  size_t i_;
+  std::future<void> pending_;
+};
+
+// A sorted run: a temporary file holding the elements [start, end) of the non-NA sequence
+struct Extsort_run {
+  std::unique_ptr<Extsort_file> file;
+  double start;
+  double end;
+};
+
+template<class T>
+static void Extsort_copy(Extsort_reader<T>& in, Extsort_writer<T>& out) {
+  size_t m;
+  while (!in.empty()){
+    const T* p = in.rest(&m);
+    out.write(p, m);
+    in.skip();
+  }
+}
+
+// Merges the runs (in sequence order) into out, ties are taken from the earlier run (stable)
+template<class T, class C>
+static void Extsort_merge(std::vector<Extsort_run>& runs, Extsort_writer<T>& out, size_t block, Extsort_io* io, C comp) {
+  std::vector<std::unique_ptr<Extsort_reader<T>>> in;
+  for (auto& r : runs)
+    in.emplace_back(new Extsort_reader<T>(*r.file, r.file->bytes, block, io));
+  std::vector<int> heap;
+  for (int i=0;i<(int)in.size();i++)
+    if (!in[i]->empty())
+      heap.push_back(i);
+  auto before = [&](int a, int b){
+    T x = in[a]->head(), y = in[b]->head();
+    return comp(x, y) || (!comp(y, x) && a < b);
+  };
+  std::make_heap(heap.begin(), heap.end(), [&](int a, int b){ return before(b, a); });
+  size_t h = heap.size();
+  while (h > 1){
+    int t = heap[0];
+    out.push(in[t]->head());
+    in[t]->pop();
+    if (in[t]->empty())
+      heap[0] = heap[--h];
+    // sift the root down
+    size_t i = 0;
+    int v = heap[0];
+    for (;;){
+      size_t c = 2 * i + 1;
+      if (c >= h)
+        break;
+      if (c + 1 < h && before(heap[c + 1], heap[c]))
+        c++;
+      if (!before(heap[c], v))
+        break;
+      heap[i] = heap[c];
+      i = c;
+    }
+    heap[i] = v;
+  }
+  if (h)
+    Extsort_copy(*in[heap[0]], out);
+}
+
+// Power of the boundary between the runs [s1, e1) and [e1, e2) of n elements in base k
+static int Extsort_power(double s1, double e1, double e2, double n, int k) {
+  double a = (s1 + e1) / (2 * n), b = (e1 + e2) / (2 * n);
+  int p = 0;
+  while (p < 64){
+    p++;
+    a *= k;
+    b *= k;
+    double da = std::floor(a), db = std::floor(b);
+    if (da != db)
+      break;
+    a -= da;
+    b -= db;
+  }
+  return p;
+}
+
+template<class T, class C>
+static void Extsort_chunk(T* begin, T* end, int engine, int threads, bool decreasing, C comp, greensort_buffer<T>& buf) {
+  switch (engine){
+  case EXTSORT_IPS4O:
+    ips4o::parallel::sort(begin, end, comp, threads);
+    break;
+  case EXTSORT_IS4O:
+    ips4o::sort(begin, end, comp);
+    break;
+  case EXTSORT_PPDQSORT:
+    pdqsort_parallel(begin, end, comp, threads);
+    break;
+  case EXTSORT_PDQSORT:
+    pdqsort(begin, end, comp);
+    break;
+  case EXTSORT_SKASORT: {
+    GreensortRadixKey key(true, decreasing);
+    buf.resize(end - begin);
+    if (ska::RadixSorter<decltype(key(*begin))>::sort(begin, end, buf.begin(), key))
+      std::copy(buf.begin(), buf.begin() + (end - begin), begin);
+    break;
+  }
+  default:
+    throw std::invalid_argument("unknown engine");
+  }
+}
+
+// Seconds, bytes and energy of a phase
+struct Extsort_phase {
+  double secs = 0;
+  double read = 0;
+  double written = 0;
+  GreensortEnergyT energy = {0, 0, 0, 0};
+};
+
+// Accounts the time, I/O and energy since the last switch to the current phase
+class Extsort_meter {
+public:
+  explicit Extsort_meter(Extsort_io* io) : io_(io), cur_(nullptr) {}
+  void to(Extsort_phase* phase) {
+    auto now = std::chrono::high_resolution_clock::now();
+    std::uint64_t r = io_->read, w = io_->written;
+    if (cur_){
+      GreensortEnergyT e = GreensortEnergyDelta(&energy_);
+      cur_->secs += std::chrono::duration <double, std::ratio<1,1>> (now - start_).count();
+      cur_->read += r - read_;
+      cur_->written += w - written_;
+      cur_->energy.base += e.base;
+      cur_->energy.core += e.core;
+      cur_->energy.unco += e.unco;
+      cur_->energy.dram += e.dram;
+    }else{
+      energy_ = GreensortEnergyNow();
+    }
+    cur_ = phase;
+    start_ = now;
+    read_ = r;
+    written_ = w;
+  }
+private:
+  Extsort_io* io_;
+  Extsort_phase* cur_;
+  std::chrono::high_resolution_clock::time_point start_;
+  std::uint64_t read_ = 0, written_ = 0;
+  PCapEnergyT energy_;
+};
+
+template<class T, class C>
+static List Extsort_sort(const std::string& infile, const std::string& outfile, double budget, int fanin, int engine, int threads, bool na_last, bool decreasing, const std::string& tmpdir, bool direct, C comp) {
+  Extsort_io io;
+  Extsort_phase phase[3];
+  Extsort_meter meter(&io);
+  double faults0 = GreensortPageFaults();
+  size_t k = std::max(fanin, 2);
+  size_t block = std::max((size_t) (budget / (2.0 * (k + 1))) / Extsort_align * Extsort_align, (size_t) 65536);
+  size_t chunk = std::max((size_t) std::max(budget - 6.0 * block, 0.0) / sizeof(T), block / sizeof(T));
+  if (engine == EXTSORT_SKASORT)
+    chunk = std::max(chunk / 2, block / sizeof(T));
+  std::vector<Extsort_run> runs;
+  Extsort_file na(tmpdir, direct);
+  double n, nna = 0, merges = 0;
+  meter.to(&phase[0]);
+
+  // runs
+  {
+    Extsort_file in(infile, O_RDONLY, false);
+    struct stat st;
+    if (fstat(in.fd, &st) != 0)
+      throw Extsort_error("cannot stat '" + infile + "'");
+    if (st.st_size % sizeof(T))
+      throw std::runtime_error("the size of '" + infile + "' is not a multiple of the element size");
+    n = (double) (st.st_size / sizeof(T));
+    chunk = std::min(chunk, std::max((size_t) n, (size_t) 1));
+    Extsort_reader<T> r(in, st.st_size, block, &io);
+    Extsort_writer<T> naw(na, block, &io);
+    std::unique_ptr<Extsort_writer<T>> w;
+    greensort_buffer<T> a, buf;
+    a.resize(chunk);
+    double pos = 0;
+    T last = T();
+    while (!r.empty()){
+      size_t i, j, m = r.read(a.data(), chunk);
+      for (i=0,j=0;i<m;i++){
+        if (GreensortIsNA(a[i]))
+          naw.push(a[i]);
+        else
+          a[j++] = a[i];
+      }
+      nna += m - j;
+      m = j;
+      if (!m)
+        continue;
+      if (!std::is_sorted(a.begin(), a.begin() + m, comp))
+        Extsort_chunk(a.begin(), a.begin() + m, engine, threads, decreasing, comp, buf);
+      if (!w || comp(a[0], last)){
+        if (w){
+          w->finish();
+          runs.back().end = pos;
+        }
+        runs.push_back(Extsort_run{std::unique_ptr<Extsort_file>(new Extsort_file(tmpdir, direct)), pos, pos});
+        w.reset(new Extsort_writer<T>(*runs.back().file, block, &io));
+      }
+      w->write(a.data(), m);
+      last = a[m - 1];
+      pos += m;
+    }
+    if (w){
+      w->finish();
+      runs.back().end = pos;
+    }
+    naw.finish();
+  }
+  double nruns = runs.size(), nvalues = n - nna;
+
+  // merge: multiway powersort over the runs, leaving the at most k last runs for the final merge
+  meter.to(&phase[1]);
+  auto merge = [&](std::vector<Extsort_run>& group) {
+    Extsort_run r{std::unique_ptr<Extsort_file>(new Extsort_file(tmpdir, direct)), group.front().start, group.back().end};
+    {
+      Extsort_writer<T> w(*r.file, block, &io);
+      Extsort_merge(group, w, block, &io, comp);
+      w.finish();
+    }
+    merges++;
+    return r;
+  };
+  struct entry {
+    Extsort_run run;
+    int power;
+  };
+  std::vector<entry> stack;
+  std::vector<Extsort_run> last;
+  if (runs.size() <= k){
+    last = std::move(runs);
+  }else{
+    Extsort_run a = std::move(runs[0]);
+    // pops the runs of the top power (at most k-1 in base k) and merges them with a
+    auto collapse = [&]() {
+      int q = stack.back().power;
+      size_t j = stack.size();
+      while (j > 0 && stack[j-1].power == q)
+        j--;
+      std::vector<Extsort_run> group;
+      for (size_t l=j;l<stack.size();l++)
+        group.push_back(std::move(stack[l].run));
+      group.push_back(std::move(a));
+      stack.resize(j);
+      a = merge(group);
+    };
+    for (size_t i=1;i<runs.size();i++){
+      int p = Extsort_power(a.start, a.end, runs[i].end, nvalues, (int) k);
+      while (!stack.empty() && stack.back().power > p)
+        collapse();
+      stack.push_back(entry{std::move(a), p});
+      a = std::move(runs[i]);
+    }
+    while (stack.size() + 1 > k)
+      collapse();
+    for (auto& e : stack)
+      last.push_back(std::move(e.run));
+    last.push_back(std::move(a));
+  }
+
+  // final: the NA and the merge of the last runs into the output
+  meter.to(&phase[2]);
+  {
+    Extsort_file out(outfile, O_WRONLY | O_CREAT | O_TRUNC, direct);
+    Extsort_writer<T> w(out, block, &io);
+    auto copy_na = [&]() {
+      if (!na.bytes)
+        return;
+      Extsort_reader<T> r(na, na.bytes, block, &io);
+      Extsort_copy(r, w);
+    };
+    if (!na_last)
+      copy_na();
+    if (last.size() == 1){
+      Extsort_reader<T> r(*last[0].file, last[0].file->bytes, block, &io);
+      Extsort_copy(r, w);
+    }else if (last.size() > 1){
+      Extsort_merge(last, w, block, &io, comp);
+      merges++;
+    }
+    if (na_last)
+      copy_na();
+    w.finish();
+  }
+  meter.to(nullptr);
+
+  NumericVector ret(10), phases(21);
+  double secs = 0, written = 0;
+  for (int i=0;i<3;i++){
+    phases[i] = phase[i].secs;
+    phases[3 + i] = phase[i].read;
+    phases[6 + i] = phase[i].written;
+    phases[9 + i] = phase[i].energy.base;
+    phases[12 + i] = phase[i].energy.core;
+    phases[15 + i] = phase[i].energy.unco;
+    phases[18 + i] = phase[i].energy.dram;
+    secs += phase[i].secs;
+    written += phase[i].written;
+    ret[6] += phase[i].energy.base;
+    ret[7] += phase[i].energy.core;
+    ret[8] += phase[i].energy.unco;
+    ret[9] += phase[i].energy.dram;
+  }
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = engine == EXTSORT_IPS4O || engine == EXTSORT_PPDQSORT ? threads : 1;
+  ret[3] = 1;
+  // the memory budget relative to the data
+  ret[4] = n ? budget / (n * sizeof(T)) : 0;
+  ret[5] = secs;
+  return List::create(
+    Named("ret") = ret
+  , Named("phases") = phases
+  , Named("runs") = nruns
+  , Named("merges") = merges
+  , Named("passes") = n ? written / (n * sizeof(T)) : 0
+  , Named("faults") = GreensortPageFaults() - faults0
+  );
+}
+
+template<class T>
+static List Extsort_files(const std::string& infile, const std::string& outfile, double budget, int fanin, int engine, int threads, bool na_last, bool decreasing, const std::string& tmpdir, bool direct) {
+  if (decreasing)
+    return Extsort_sort<T>(infile, outfile, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct, std::greater<>{});
+  return Extsort_sort<T>(infile, outfile, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct, std::less<>{});
+}
+
+// [[Rcpp::export]]
+List Extsort_files(std::string infile, std::string outfile, std::string type, double budget, int fanin, int engine, int threads, bool na_last, bool decreasing, std::string tmpdir, bool direct) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (type == "double")
+    return Extsort_files<double>(infile, outfile, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct);
+  if (type == "integer")
+    return Extsort_files<int>(infile, outfile, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct);
+  if (type == "integer64")
+    return Extsort_files<std::int64_t>(infile, outfile, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct);
+  stop("type must be double, integer or integer64");
+}
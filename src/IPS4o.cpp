@@ -10,25 +10,34 @@
 #include <chrono>
 
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 using namespace Rcpp;
 
 
-// [[Rcpp::export]]
-List IPS4o_insitu(NumericVector & orig) {
+template<typename T>
+List IPS4o_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
   NumericVector ret(10);
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-    ips4o::parallel::sort(orig.begin(), orig.end(), std::less<>{});
-    //STABLE_TEST_PSEUDO_ROUND - is NOT stable: ips4o::parallel::sort(orig.begin(), orig.end(), [](auto x, auto y){ return floor(x) < floor(y); });
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    if (decreasing)
+      ips4o::parallel::sort(x.begin(), x.end(), std::greater<>{});
+    else
+      ips4o::parallel::sort(x.begin(), x.end(), std::less<>{});
+    //STABLE_TEST_PSEUDO_ROUND - is NOT stable: ips4o::parallel::sort(x.begin(), x.end(), [](auto x, auto y){ return floor(x) < floor(y); });
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = (double (n+sqrt(n)))/n;
@@ -37,29 +46,41 @@ List IPS4o_insitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
-
 // [[Rcpp::export]]
-List IPS4o_exsitu(NumericVector & orig) {
+List IPS4o_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return IPS4o_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List IPS4o_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
     int i,n=orig.size();
     NumericVector ret(10);
     PCapEnergyT eLast;
     GreensortEnergyT eNext;
+    double faults0 = GreensortPageFaults();
     eLast = GreensortEnergyNow();
     auto start = std::chrono::high_resolution_clock::now();
-    NumericVector aux(n);
-    for (i=0;i<n;i++)
-        aux[i] = orig[i];
-    ips4o::parallel::sort(aux.begin(), aux.end(), std::less<>{});
-    for (i=0;i<n;i++)
-        orig[i] = aux[i];
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    greensort_buffer<T> aux(false);
+    aux.resize(x.size());
+    for (i=0;i<x.size();i++)
+        aux[i] = x[i];
+    if (decreasing)
+      ips4o::parallel::sort(aux.begin(), aux.end(), std::greater<>{});
+    else
+      ips4o::parallel::sort(aux.begin(), aux.end(), std::less<>{});
+    for (i=0;i<x.size();i++)
+        x[i] = aux[i];
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = (double (n+sqrt(n)))/n;
@@ -68,27 +89,38 @@ List IPS4o_exsitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
+// [[Rcpp::export]]
+List IPS4o_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return IPS4o_exsitu(x, na_last, decreasing); });
+}
 
 
 
-// [[Rcpp::export]]
-List IS4o_insitu(NumericVector & orig) {
+
+template<typename T>
+List IS4o_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   int n=orig.size();
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  ips4o::sort(orig.begin(), orig.end(), std::less<>{});
-  //STABLE_TEST_PSEUDO_ROUND - is NOT stable: ips4o::sort(orig.begin(), orig.end(), [](auto x, auto y){ return floor(x) < floor(y); });
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    ips4o::sort(x.begin(), x.end(), std::greater<>{});
+  else
+    ips4o::sort(x.begin(), x.end(), std::less<>{});
+  //STABLE_TEST_PSEUDO_ROUND - is NOT stable: ips4o::sort(x.begin(), x.end(), [](auto x, auto y){ return floor(x) < floor(y); });
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = (double (n+sqrt(n)))/n;
@@ -97,29 +129,41 @@ List IS4o_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
-
 // [[Rcpp::export]]
-List IS4o_exsitu(NumericVector & orig) {
+List IS4o_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return IS4o_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List IS4o_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
     int i,n=orig.size();
     NumericVector ret(10);
     PCapEnergyT eLast;
     GreensortEnergyT eNext;
+    double faults0 = GreensortPageFaults();
     eLast = GreensortEnergyNow();
     auto start = std::chrono::high_resolution_clock::now();
-    NumericVector aux(n);
-    for (i=0;i<n;i++)
-        aux[i] = orig[i];
-    ips4o::sort(aux.begin(), aux.end(), std::less<>{});
-    for (i=0;i<n;i++)
-        orig[i] = aux[i];
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    greensort_buffer<T> aux(false);
+    aux.resize(x.size());
+    for (i=0;i<x.size();i++)
+        aux[i] = x[i];
+    if (decreasing)
+      ips4o::sort(aux.begin(), aux.end(), std::greater<>{});
+    else
+      ips4o::sort(aux.begin(), aux.end(), std::less<>{});
+    for (i=0;i<x.size();i++)
+        x[i] = aux[i];
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = (double (n+sqrt(n)))/n;
@@ -128,5 +172,10 @@ List IS4o_exsitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults);
+}
+
+// [[Rcpp::export]]
+List IS4o_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return IS4o_exsitu(x, na_last, decreasing); });
 }
@@ -7,26 +7,74 @@
 
 #include <Rcpp.h>
 #include "learn/learned_sort.h"
+#include "learn/learned_sort_parallel.h"
+#include "learn/learned_sort_robust.h"
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <stdexcept>
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 using namespace Rcpp;
 
+// Per-call hyperparameters, autotune overrides fanout and sampling_rate
+template<typename T>
+static typename RMI<T>::Params Learnsort_params(int n, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune){
+  typename RMI<T>::Params p;
+  if (autotune){
+    p = RMI<T>::Params::autotuned(n);
+  }else{
+    p.fanout = fanout;
+    p.sampling_rate = sampling_rate;
+  }
+  p.overallocation_ratio = overallocation;
+  p.batch_sz = batch_sz;
+  p.threshold = threshold;
+  return p;
+}
 
-// [[Rcpp::export]]
-List Learnsort_insitu(NumericVector & orig) {
+template<typename P>
+static NumericVector Learnsort_hp(P & p){
+  return NumericVector::create(
+    Named("sampling_rate") = p.sampling_rate
+  , Named("fanout") = p.fanout
+  , Named("batch_sz") = p.batch_sz
+  , Named("overallocation") = p.overallocation_ratio
+  , Named("threshold") = p.threshold
+  );
+}
+
+// Number of keys that went to the spill bucket (or comparison sort fallback) and exception (repeated key) paths
+static NumericVector Learnsort_counts(learned_sort::sort_stats & stats){
+  return NumericVector::create(
+    Named("spill") = stats.n_spill
+  , Named("exceptions") = stats.n_exceptions
+  );
+}
+
+template<typename T>
+List Learnsort_insitu(greensort_span<T> orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
   NumericVector ret(10);
+  typename RMI<T>::Params p = Learnsort_params<T>(n, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune);
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-    learned_sort::sort(orig.begin(), orig.end());
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    learned_sort::sort_stats stats = robust ? learned_sort::robust_sort(x.begin(), x.end(), p) : learned_sort::sort(x.begin(), x.end(), p);
+    if (decreasing)
+      std::reverse(x.begin(), x.end());
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = 2.0;
@@ -35,26 +83,159 @@ List Learnsort_insitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults, Named("hp") = Learnsort_hp(p), Named("stats") = Learnsort_counts(stats));
+}
+
+// [[Rcpp::export]]
+List Learnsort_insitu(SEXP orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Learnsort_insitu(x, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune, robust, na_last, decreasing); });
+}
+
+
+template<typename T>
+List Learnsort_exsitu(greensort_span<T> orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing) {
+  int i,n=orig.size();
+  NumericVector ret(10);
+  typename RMI<T>::Params p = Learnsort_params<T>(n, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  learned_sort::sort_stats stats = robust ? learned_sort::robust_sort(aux.begin(), aux.end(), p) : learned_sort::sort(aux.begin(), aux.end(), p);
+  if (decreasing)
+    std::reverse(aux.begin(), aux.end());
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 2.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("hp") = Learnsort_hp(p), Named("stats") = Learnsort_counts(stats));
+}
+
+// [[Rcpp::export]]
+List Learnsort_exsitu(SEXP orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Learnsort_exsitu(x, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune, robust, na_last, decreasing); });
+}
+
+
+
+// Reusable models: train once, sort many batches from the same distribution
+
+static RMI<double> * Learnsort_model_ptr(SEXP model){
+  if (TYPEOF(model) != EXTPTRSXP)
+    stop("model must be an external pointer created by Learnsort_train");
+  RMI<double> *rmi = static_cast<RMI<double>*>(R_ExternalPtrAddr(model));
+  if (rmi == NULL)
+    stop("model pointer is NULL (restored from a saved session?), use Learnsort_unserialize");
+  return rmi;
+}
+
+// Sorts with the model, retrains on the (now sorted) data if the spill rate exceeds drift
+static learned_sort::sort_stats Learnsort_model_sort(double *begin, double *end, RMI<double> *rmi, double drift, bool *retrained){
+  int n = end - begin;
+  learned_sort::sort_stats stats = learned_sort::sort(begin, end, *rmi);
+  *retrained = false;
+  if (rmi->trained && n > 0 && stats.n_spill > drift * n){
+    RMI<double>::Params p = rmi->hp;
+    *rmi = learned_sort::train(begin, end, p);
+    *retrained = true;
+  }
+  return stats;
+}
+
+static NumericVector Learnsort_stats(learned_sort::sort_stats & stats, bool retrained){
+  return NumericVector::create(
+    Named("spill") = stats.n_spill
+  , Named("exceptions") = stats.n_exceptions
+  , Named("retrained") = retrained
+  );
+}
+
+// [[Rcpp::export]]
+SEXP Learnsort_train(NumericVector & orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune) {
+  int n=orig.size();
+  RMI<double>::Params p = Learnsort_params<double>(n, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune);
+  XPtr< RMI<double> > model(new RMI<double>(learned_sort::train(orig.begin(), orig.end(), p)), true);
+  model.attr("hp") = Learnsort_hp(model->hp);
+  return model;
+}
+
+// [[Rcpp::export]]
+List Learnsort_model_insitu(NumericVector & orig, SEXP model, double drift, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int n=orig.size();
+  NumericVector ret(10);
+  RMI<double> *rmi = Learnsort_model_ptr(model);
+  bool retrained;
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<double> x = GreensortNaSplit(greensort_span<double>(orig.begin(), n, REALSXP), na_last);
+  learned_sort::sort_stats stats = Learnsort_model_sort(x.begin(), x.end(), rmi, drift, &retrained);
+  if (decreasing)
+    std::reverse(x.begin(), x.end());
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = 8;
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 2.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("stats") = Learnsort_stats(stats, retrained), Named("alloc") = GreensortBufferAllocSecs() - alloc0);
 }
 
 
 // [[Rcpp::export]]
-List Learnsort_exsitu(NumericVector & orig) {
+List Learnsort_model_exsitu(NumericVector & orig, SEXP model, double drift, bool na_last, bool decreasing) {
   int i,n=orig.size();
   NumericVector ret(10);
+  RMI<double> *rmi = Learnsort_model_ptr(model);
+  bool retrained;
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
-  for (i=0;i<n;i++)
-      aux[i] = orig[i];
-  learned_sort::sort(aux.begin(), aux.end());
-  for (i=0;i<n;i++)
-      orig[i] = aux[i];
+  greensort_span<double> x = GreensortNaSplit(greensort_span<double>(orig.begin(), n, REALSXP), na_last);
+  greensort_buffer<double> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+    aux[i] = x[i];
+  learned_sort::sort_stats stats = Learnsort_model_sort(aux.begin(), aux.end(), rmi, drift, &retrained);
+  if (decreasing)
+    std::reverse(aux.begin(), aux.end());
+  for (i=0;i<x.size();i++)
+    x[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
   ret[1] = 8;
@@ -66,6 +247,110 @@ List Learnsort_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("stats") = Learnsort_stats(stats, retrained), Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
+
+// [[Rcpp::export]]
+NumericVector Learnsort_serialize(SEXP model) {
+  RMI<double> *rmi = Learnsort_model_ptr(model);
+  std::vector<double> v = learned_sort::serialize(*rmi);
+  return NumericVector(v.begin(), v.end());
+}
+
+// [[Rcpp::export]]
+SEXP Learnsort_unserialize(NumericVector & v) {
+  std::unique_ptr< RMI<double> > rmi;
+  try {
+    // a truncated or foreign vector is rejected before anything is read out of its range
+    rmi.reset(new RMI<double>(learned_sort::deserialize<double>(v.begin(), v.size())));
+  } catch (std::invalid_argument& e) {
+    stop(e.what());
+  }
+  XPtr< RMI<double> > model(rmi.release(), true);
+  model.attr("hp") = Learnsort_hp(model->hp);
+  return model;
+}
+
+
+// Multi-threaded learned sort, threads=0 uses all hardware threads
+
+template<typename T>
+List PLearnsort_insitu(greensort_span<T> orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int n=orig.size();
+  NumericVector ret(10);
+  typename RMI<T>::Params p = Learnsort_params<T>(n, sampling_rate, RMI<T>::Params::DEFAULT_OVERALLOCATION_RATIO, fanout, RMI<T>::Params::DEFAULT_BATCH_SZ, RMI<T>::Params::DEFAULT_THRESHOLD, autotune);
+  unsigned int t = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    learned_sort::sort_stats stats = learned_sort::parallel_sort(x.begin(), x.end(), p, t);
+    if (decreasing)
+      std::reverse(x.begin(), x.end());
+    auto stop = std::chrono::high_resolution_clock::now();
+    eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
+    auto diff = stop - start;
+    ret[0] = n;
+    ret[1] = sizeof(T);
+    ret[2] = t;
+    ret[3] = 1;
+    ret[4] = 2.0;
+    ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+    ret[6] = eNext.base;
+    ret[7] = eNext.core;
+    ret[8] = eNext.unco;
+    ret[9] = eNext.dram;
+    return List::create(Named("ret") = ret, Named("faults") = faults, Named("hp") = Learnsort_hp(p), Named("stats") = Learnsort_counts(stats));
+}
+
+// [[Rcpp::export]]
+List PLearnsort_insitu(SEXP orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PLearnsort_insitu(x, threads, sampling_rate, fanout, autotune, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PLearnsort_exsitu(greensort_span<T> orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing) {
+  int i,n=orig.size();
+  NumericVector ret(10);
+  typename RMI<T>::Params p = Learnsort_params<T>(n, sampling_rate, RMI<T>::Params::DEFAULT_OVERALLOCATION_RATIO, fanout, RMI<T>::Params::DEFAULT_BATCH_SZ, RMI<T>::Params::DEFAULT_THRESHOLD, autotune);
+  unsigned int t = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  learned_sort::sort_stats stats = learned_sort::parallel_sort(aux.begin(), aux.end(), p, t);
+  if (decreasing)
+    std::reverse(aux.begin(), aux.end());
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = t;
+  ret[3] = 1;
+  ret[4] = 2.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("hp") = Learnsort_hp(p), Named("stats") = Learnsort_counts(stats));
 }
 
+// [[Rcpp::export]]
+List PLearnsort_exsitu(SEXP orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PLearnsort_exsitu(x, threads, sampling_rate, fanout, autotune, na_last, decreasing); });
+}
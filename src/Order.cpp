@@ -0,0 +1,201 @@
+/*
+# Code for interfacing and timing the order mode (sorting permutations) of all engines
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+#include "power/algorithms.h"
+#include "power/inputs.h"
+#include "power/sorts/peeksort.h"
+#include "power/sorts/powersort.h"
+#include "tim/timsort.h"
+#include "tim/timsort_parallel.h"
+#include "ips4o/ips4o.hpp"
+#include "pdq/pdqsort.h"
+#include "ska/ska_sort.hpp"
+#include "learn/learned_sort.h"
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "order.h"
+#include "sort_types.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+// Learnsort sorts the keys only, the records are then placed at the first position of their key
+// in the sorted keys plus the number of equal keys already placed (stable)
+template<class K>
+static void Learnsort_order(greensort_order_record<K>* begin, greensort_order_record<K>* end){
+  size_t i, n = end - begin;
+  greensort_buffer<K> keys;
+  keys.resize(n);
+  for (i=0;i<n;i++)
+    keys[i] = begin[i].key;
+  typename RMI<K>::Params p = RMI<K>::Params::autotuned(n);
+  learned_sort::sort(keys.begin(), keys.end(), p);
+  greensort_buffer<size_t> fill;
+  fill.resize(n);
+  std::memset(fill.data(), 0, n * sizeof(size_t));
+  greensort_buffer<greensort_order_record<K>> out;
+  out.resize(n);
+  for (i=0;i<n;i++){
+    size_t pos = std::lower_bound(keys.begin(), keys.end(), begin[i].key) - keys.begin();
+    out[pos + fill[pos]++] = begin[i];
+  }
+  std::copy(out.begin(), out.end(), begin);
+}
+
+// The radix engines see the bits of the key, -0.0 + 0.0 is +0.0 such that equal zeros are ties
+static inline double Order_radix_key(double k){ return k + 0.0; }
+static inline int Order_radix_key(int k){ return k; }
+static inline std::int64_t Order_radix_key(std::int64_t k){ return k; }
+
+template<class K>
+size_t GreensortOrderFill(greensort_order_record<K>* rec, const K* x, size_t n){
+  size_t i, m = 0;
+  if (!GreensortNaCount(x, n)){
+    for (i=0;i<n;i++)
+      rec[i] = greensort_order_record<K>{x[i], (std::int64_t) i};
+    return n;
+  }
+  for (i=0;i<n;i++)
+    if (!GreensortIsNA(x[i]))
+      rec[m++] = greensort_order_record<K>{x[i], (std::int64_t) i};
+  size_t k = m;
+  for (i=0;i<n;i++)
+    if (GreensortIsNA(x[i]))
+      rec[k++] = greensort_order_record<K>{x[i], (std::int64_t) i};
+  return m;
+}
+
+template<class K>
+void GreensortOrderRecords(greensort_order_record<K>* begin, greensort_order_record<K>* end, int engine, int threads){
+  typedef greensort_order_record<K> record_t;
+  if (end - begin < 2)
+    return;
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  switch (engine){
+  case GREENSORT_ORDER_PEEKSORT:
+    std::make_unique<peekpower::peeksort<record_t *, 64, false, peekpower::COPY_SMALLER>>()->sort(begin, end);
+    break;
+  case GREENSORT_ORDER_POWERSORT:
+    std::make_unique<peekpower::powersort<record_t *, 64, peekpower::COPY_SMALLER, false>>()->sort(begin, end);
+    break;
+  case GREENSORT_ORDER_TIMSORT:
+    tim::timsort(begin, end, std::less<>{});
+    break;
+  case GREENSORT_ORDER_PTIMSORT:
+    tim::timsort_parallel(begin, end, std::less<>{}, threads);
+    break;
+  case GREENSORT_ORDER_IPS4O:
+    ips4o::parallel::sort(begin, end, greensort_order_less{}, threads);
+    break;
+  case GREENSORT_ORDER_IS4O:
+    ips4o::sort(begin, end, greensort_order_less{});
+    break;
+  case GREENSORT_ORDER_PDQSORT:
+    pdqsort(begin, end, greensort_order_less{});
+    break;
+  case GREENSORT_ORDER_SKASORT: {
+    greensort_buffer<record_t> buf;
+    buf.resize(end - begin);
+    if (ska::RadixSorter<K>::sort(begin, end, buf.begin(), [](const record_t& r){ return Order_radix_key(r.key); }))
+      std::copy(buf.begin(), buf.end(), begin);
+    break;
+  }
+  case GREENSORT_ORDER_ISKASORT: {
+    auto extract_key = [](const record_t& r){ return std::make_pair(Order_radix_key(r.key), r.index); };
+    ska::inplace_radix_sort<1, 1>(begin, end, extract_key);
+    break;
+  }
+  case GREENSORT_ORDER_LEARNSORT:
+    Learnsort_order(begin, end);
+    break;
+  default:
+    throw std::invalid_argument("unknown order engine");
+  }
+}
+
+template size_t GreensortOrderFill<double>(greensort_order_record<double>*, const double*, size_t);
+template size_t GreensortOrderFill<int>(greensort_order_record<int>*, const int*, size_t);
+template size_t GreensortOrderFill<std::int64_t>(greensort_order_record<std::int64_t>*, const std::int64_t*, size_t);
+template void GreensortOrderRecords<double>(greensort_order_record<double>*, greensort_order_record<double>*, int, int);
+template void GreensortOrderRecords<int>(greensort_order_record<int>*, greensort_order_record<int>*, int, int);
+template void GreensortOrderRecords<std::int64_t>(greensort_order_record<std::int64_t>*, greensort_order_record<std::int64_t>*, int, int);
+
+double GreensortOrderBuffer(int engine){
+  switch (engine){
+  case GREENSORT_ORDER_PEEKSORT:
+  case GREENSORT_ORDER_POWERSORT:
+  case GREENSORT_ORDER_TIMSORT:
+    return 0.5;
+  case GREENSORT_ORDER_PTIMSORT:
+  case GREENSORT_ORDER_SKASORT:
+  case GREENSORT_ORDER_LEARNSORT:
+    return 1.0;
+  default:
+    return 0.0;
+  }
+}
+
+
+template<typename T>
+List Order_engine(greensort_span<T> orig, int engine, int threads) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  R_xlen_t i, m, n=orig.size();
+  NumericVector ret(10);
+  bool long_vector = n > INT_MAX;
+  IntegerVector iorder(long_vector ? 0 : n);
+  NumericVector dorder(long_vector ? n : 0);
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_buffer<greensort_order_record<T>> rec;
+  rec.resize(n);
+  m = GreensortOrderFill(rec.data(), orig.begin(), n);
+  GreensortOrderRecords(rec.begin(), rec.begin() + m, engine, threads);
+  if (long_vector){
+    for (i=0;i<n;i++)
+      dorder[i] = rec[i].index + 1;
+  }else{
+    for (i=0;i<n;i++)
+      iorder[i] = rec[i].index + 1;
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = engine == GREENSORT_ORDER_PTIMSORT || engine == GREENSORT_ORDER_IPS4O ? threads : 1;
+  ret[3] = 1;
+  // the data plus the records with their buffer plus the permutation (bytes per element)
+  ret[4] = 1.0 + (16.0 * (1.0 + GreensortOrderBuffer(engine)) + (long_vector ? 8.0 : 4.0)) / sizeof(T);
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  if (long_vector)
+    return List::create(Named("ret") = ret, Named("order") = dorder, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+  return List::create(Named("ret") = ret, Named("order") = iorder, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
+
+// [[Rcpp::export]]
+List Order_engine(SEXP orig, int engine, int threads) {
+  return GreensortDispatch(orig, [&](auto x){ return Order_engine(x, engine, threads); });
+}
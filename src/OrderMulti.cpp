@@ -0,0 +1,272 @@
+/*
+# Code for interfacing and timing the multi-key order (lexicographic over several columns)
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ OrderMulti orders the rows of several columns lexicographically. The records of order.h carry
+ the unsigned radix key of one column (GreensortRadixKey: per column decreasing and NA first or
+ last) and the row. The first column is sorted as one tie group, then each group of rows tied
+ on all previous columns is refined by the next column: the keys of its rows are gathered, the
+ group is sorted and split into the runs of equal keys, which are the groups of the next
+ column. Refinement stops when no group with more than one row is left.
+
+ Each group is sorted with the engine fitting its size and presortedness, counted while the
+ keys are gathered:
+   sorted     no descent: nothing to do
+   reverse    every pair descends: reversing is stable as there are no ties
+   insertion  up to 16 rows
+   powersort  few descents (at most 1/32 of the pairs): merging the runs is cheaper
+   pdqsort    up to 4096 rows, ties broken by row
+   skasort    LSD radix on 32 bit (double and integer64: 64 bit) keys
+   ips4o      groups of at least n/threads rows with more than one thread
+ All engines keep tied rows in increasing row order, hence the permutation is stable like
+ order(..., method="radix"). The groups below n/threads rows are distributed over the threads
+ in contiguous chunks of rows, each thread gathers, sorts and splits only its own groups.
+*/
+
+#include "power/algorithms.h"
+#include "power/inputs.h"
+#include "power/sorts/powersort.h"
+#include "ips4o/ips4o.hpp"
+#include "pdq/pdqsort.h"
+#include "ska/ska_sort.hpp"
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "order.h"
+#include "sort_types.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+typedef greensort_order_record<std::uint64_t> OrderMulti_record;
+
+enum OrderMulti_engine {
+  ORDERMULTI_SORTED = 0
+, ORDERMULTI_REVERSE = 1
+, ORDERMULTI_INSERTION = 2
+, ORDERMULTI_POWERSORT = 3
+, ORDERMULTI_PDQSORT = 4
+, ORDERMULTI_SKASORT = 5
+, ORDERMULTI_IPS4O = 6
+, ORDERMULTI_ENGINES = 7
+};
+
+// A key column: its data typed by the R storage and the radix key of its order
+struct OrderMulti_column {
+  SEXPTYPE type;
+  bool int64;
+  const void* data;
+  GreensortRadixKey key;
+};
+
+// Gathers the keys of column c for the rows of the records, returns the number of descents
+static size_t OrderMulti_gather(OrderMulti_record* r, size_t g, const OrderMulti_column& c){
+  size_t i, desc = 0;
+  if (c.type == REALSXP && c.int64){
+    const std::int64_t* x = static_cast<const std::int64_t*>(c.data);
+    for (i=0;i<g;i++)
+      r[i].key = c.key(x[r[i].index]);
+  }else if (c.type == REALSXP){
+    const double* x = static_cast<const double*>(c.data);
+    for (i=0;i<g;i++)
+      r[i].key = c.key(x[r[i].index]);
+  }else{
+    const int* x = static_cast<const int*>(c.data);
+    for (i=0;i<g;i++)
+      r[i].key = c.key(x[r[i].index]);
+  }
+  for (i=1;i<g;i++)
+    desc += r[i].key < r[i-1].key;
+  return desc;
+}
+
+// Sorts a group of records by key keeping ties in increasing row order, returns the engine used
+static int OrderMulti_sort(OrderMulti_record* begin, OrderMulti_record* end, size_t desc, bool wide, bool parallel, int threads){
+  size_t g = end - begin;
+  if (!desc)
+    return ORDERMULTI_SORTED;
+  if (desc == g - 1){
+    std::reverse(begin, end);
+    return ORDERMULTI_REVERSE;
+  }
+  if (g <= 16){
+    for (OrderMulti_record* i = begin + 1; i < end; i++){
+      OrderMulti_record v = *i;
+      OrderMulti_record* j = i;
+      for (; j > begin && v.key < (j - 1)->key; j--)
+        *j = *(j - 1);
+      *j = v;
+    }
+    return ORDERMULTI_INSERTION;
+  }
+  if (desc <= g / 32){
+    std::make_unique<peekpower::powersort<OrderMulti_record *, 64, peekpower::COPY_SMALLER, false>>()->sort(begin, end);
+    return ORDERMULTI_POWERSORT;
+  }
+  if (parallel){
+    ips4o::parallel::sort(begin, end, greensort_order_less{}, threads);
+    return ORDERMULTI_IPS4O;
+  }
+  if (g <= 4096){
+    pdqsort(begin, end, greensort_order_less{});
+    return ORDERMULTI_PDQSORT;
+  }
+  greensort_buffer<OrderMulti_record> buf;
+  buf.resize(g);
+  bool moved = wide
+    ? ska::RadixSorter<std::uint64_t>::sort(begin, end, buf.begin(), [](const OrderMulti_record& r){ return r.key; })
+    : ska::RadixSorter<std::uint32_t>::sort(begin, end, buf.begin(), [](const OrderMulti_record& r){ return (std::uint32_t) r.key; });
+  if (moved)
+    std::copy(buf.begin(), buf.end(), begin);
+  return ORDERMULTI_SKASORT;
+}
+
+// Refines the groups of lo <= rows < hi starting in [from, to) by column c, brk[i] marks the first
+// row of a group. Returns the number of groups with more than one row.
+static size_t OrderMulti_refine(OrderMulti_record* rec, unsigned char* brk, size_t from, size_t to, size_t n, const OrderMulti_column& c, size_t lo, size_t hi, bool parallel, int threads, size_t* count){
+  size_t b, e, i, groups = 0;
+  bool wide = c.type == REALSXP;
+  for (b=from;b<to;b=e){
+    for (e=b+1;e<n && !brk[e];e++);
+    if (e - b < 2)
+      continue;
+    groups++;
+    if (e - b < lo || e - b >= hi)
+      continue;
+    size_t desc = OrderMulti_gather(rec + b, e - b, c);
+    count[OrderMulti_sort(rec + b, rec + e, desc, wide, parallel, threads)]++;
+    for (i=b+1;i<e;i++)
+      brk[i] = rec[i].key != rec[i-1].key;
+  }
+  return groups;
+}
+
+// Sorts rec[0..n) into the lexicographic order of the rows of cols (the index of each record is
+// set to its row), count[engine] receives the number of groups sorted by each engine
+static void OrderMulti_rows(OrderMulti_record* rec, size_t n, const std::vector<OrderMulti_column>& cols, int threads, std::vector<double>& count){
+  size_t i, j;
+  greensort_buffer<unsigned char> brk;
+  brk.resize(n + 1);
+  std::memset(brk.data(), 0, n + 1);
+  brk[0] = 1;
+  brk[n] = 1;
+  for (i=0;i<n;i++)
+    rec[i].index = i;
+  // groups of at least big rows are sorted one after another by all threads, the others are
+  // distributed in chunks of rows starting at group starts
+  int chunks = n < 65536 ? 1 : threads;
+  size_t big = threads > 1 ? std::max(n / threads, (size_t) 65536) : n + 1;
+  std::vector<std::vector<size_t>> tcount(chunks, std::vector<size_t>(ORDERMULTI_ENGINES, 0));
+  std::vector<size_t> groups(chunks), from(chunks + 1);
+  for (j=0;j<cols.size();j++){
+    from[0] = 0;
+    from[chunks] = n;
+    for (int t=1;t<chunks;t++){
+      size_t s = std::max((size_t) ((double) n * t / chunks), from[t-1]);
+      while (s < n && !brk[s])
+        s++;
+      from[t] = s;
+    }
+    if (chunks == 1){
+      groups[0] = OrderMulti_refine(rec, brk.data(), 0, n, n, cols[j], 2, big, false, 1, tcount[0].data());
+    }else{
+      std::vector<std::thread> pool;
+      for (int t=0;t<chunks;t++)
+        pool.emplace_back([&, t](){
+          groups[t] = OrderMulti_refine(rec, brk.data(), from[t], from[t+1], n, cols[j], 2, big, false, 1, tcount[t].data());
+        });
+      for (auto& th : pool)
+        th.join();
+    }
+    size_t tied = 0;
+    for (int t=0;t<chunks;t++)
+      tied += groups[t];
+    if (!tied)
+      break;
+    if (big <= n)
+      OrderMulti_refine(rec, brk.data(), 0, n, n, cols[j], big, n + 1, true, threads, tcount[0].data());
+  }
+  count.assign(ORDERMULTI_ENGINES, 0.0);
+  for (int t=0;t<chunks;t++)
+    for (int l=0;l<ORDERMULTI_ENGINES;l++)
+      count[l] += tcount[t][l];
+}
+
+// [[Rcpp::export]]
+List OrderMulti_engine(List x, LogicalVector decreasing, LogicalVector na_last, int threads) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  R_xlen_t i, k = x.size(), n = k ? Rf_xlength(x[0]) : 0;
+  NumericVector ret(10);
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<OrderMulti_column> cols;
+  double bytes = 0;
+  for (i=0;i<k;i++){
+    SEXP c = x[i];
+    if (Rf_xlength(c) != n)
+      stop("all columns must have the same length");
+    if (TYPEOF(c) != REALSXP && TYPEOF(c) != INTSXP && TYPEOF(c) != LGLSXP)
+      stop("only double, integer, logical, factor and integer64 columns implemented");
+    const void* p = TYPEOF(c) == REALSXP ? (const void*) REAL(c) : TYPEOF(c) == INTSXP ? (const void*) INTEGER(c) : (const void*) LOGICAL(c);
+    cols.push_back(OrderMulti_column{(SEXPTYPE) TYPEOF(c), GreensortIsInteger64(c), p, GreensortRadixKey(na_last[i], decreasing[i])});
+    bytes += TYPEOF(c) == REALSXP ? 8 : 4;
+  }
+  bool long_vector = n > INT_MAX;
+  IntegerVector iorder(long_vector ? 0 : n);
+  NumericVector dorder(long_vector ? n : 0);
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_buffer<OrderMulti_record> rec;
+  rec.resize(n);
+  std::vector<double> count;
+  OrderMulti_rows(rec.data(), n, cols, threads, count);
+  if (long_vector){
+    for (i=0;i<n;i++)
+      dorder[i] = rec[i].index + 1;
+  }else{
+    for (i=0;i<n;i++)
+      iorder[i] = rec[i].index + 1;
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  NumericVector engines = NumericVector::create(
+    Named("sorted") = count[ORDERMULTI_SORTED]
+  , Named("reverse") = count[ORDERMULTI_REVERSE]
+  , Named("insertion") = count[ORDERMULTI_INSERTION]
+  , Named("powersort") = count[ORDERMULTI_POWERSORT]
+  , Named("pdqsort") = count[ORDERMULTI_PDQSORT]
+  , Named("skasort") = count[ORDERMULTI_SKASORT]
+  , Named("ips4o") = count[ORDERMULTI_IPS4O]
+  );
+  ret[0] = n;
+  ret[1] = bytes;
+  ret[2] = threads;
+  ret[3] = 1;
+  // the data plus the records with the radix buffer, the group marks and the permutation
+  ret[4] = bytes ? 1.0 + (16.0 * 2.0 + 1.0 + (long_vector ? 8.0 : 4.0)) / bytes : 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  if (long_vector)
+    return List::create(Named("ret") = ret, Named("order") = dorder, Named("engines") = engines, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+  return List::create(Named("ret") = ret, Named("order") = iorder, Named("engines") = engines, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
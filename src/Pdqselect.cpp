@@ -0,0 +1,178 @@
+/*
+# Code for interfacing and timing Pdqselect, Pdqpartial and Pdqquantile
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+#include <Rcpp.h>
+#include "pdq/pdqselect.h"
+#include <chrono>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+// k are sorted unique 0-based positions, NA are put last and only the ranks before them are selected
+template<typename T>
+List Pdqselect_insitu(greensort_span<T> orig, IntegerVector & k) {
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int i,n=orig.size(), m=k.size();
+  greensort_buffer<T> value;
+  value.resize(m);
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, true);
+  pdqmultiselect_branchless(x.begin(), x.end(), k.begin(), std::lower_bound(k.begin(), k.end(), x.size()), std::less<>{});
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  for (i=0;i<m;i++)
+    value[i] = orig[k[i]];
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("value") = GreensortValues(orig, value.data(), m));
+}
+
+// [[Rcpp::export]]
+List Pdqselect_insitu(SEXP orig, IntegerVector & k) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqselect_insitu(x, k); });
+}
+
+template<typename T>
+List Pdqselect_exsitu(greensort_span<T> orig, IntegerVector & k) {
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int i,n=orig.size(), m=k.size();
+  greensort_buffer<T> value;
+  value.resize(m);
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, true);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  pdqmultiselect_branchless(aux.begin(), aux.end(), k.begin(), std::lower_bound(k.begin(), k.end(), x.size()), std::less<>{});
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  for (i=0;i<m;i++)
+    value[i] = orig[k[i]];
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("value") = GreensortValues(orig, value.data(), m));
+}
+
+// [[Rcpp::export]]
+List Pdqselect_exsitu(SEXP orig, IntegerVector & k) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqselect_exsitu(x, k); });
+}
+
+// the k smallest (largest if decreasing) in sorted order at the front, NA behind them
+template<typename T>
+List Pdqpartial_insitu(greensort_span<T> orig, int k, bool decreasing) {
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int n=orig.size();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, true);
+  int m = std::min<R_xlen_t>(k, x.size());
+  if (decreasing)
+    pdqpartial_sort_branchless(x.begin(), x.begin() + m, x.end(), std::greater<>{});
+  else
+    pdqpartial_sort_branchless(x.begin(), x.begin() + m, x.end(), std::less<>{});
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("value") = GreensortValues(orig, orig.begin(), k));
+}
+
+// [[Rcpp::export]]
+List Pdqpartial_insitu(SEXP orig, int k, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqpartial_insitu(x, k, decreasing); });
+}
+
+template<typename T>
+List Pdqpartial_exsitu(greensort_span<T> orig, int k, bool decreasing) {
+  int i,n=orig.size();
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, true);
+  int m = std::min<R_xlen_t>(k, x.size());
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (decreasing)
+    pdqpartial_sort_branchless(aux.begin(), aux.begin() + m, aux.end(), std::greater<>{});
+  else
+    pdqpartial_sort_branchless(aux.begin(), aux.begin() + m, aux.end(), std::less<>{});
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("value") = GreensortValues(orig, orig.begin(), k));
+}
+
+// [[Rcpp::export]]
+List Pdqpartial_exsitu(SEXP orig, int k, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqpartial_exsitu(x, k, decreasing); });
+}
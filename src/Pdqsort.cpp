@@ -7,25 +7,35 @@
 
 #include <Rcpp.h>
 #include "pdq/pdqsort.h"
+#include "pdq/pdqsort_parallel.h"
 #include <chrono>
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 using namespace Rcpp;
 
-// [[Rcpp::export]]
-List Pdqsort_insitu(NumericVector & orig) {
+template<typename T>
+List Pdqsort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  pdqsort(orig.begin(), orig.end(), std::less<>{});
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    pdqsort(x.begin(), x.end(), std::greater<>{});
+  else
+    pdqsort(x.begin(), x.end(), std::less<>{});
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.0;
@@ -34,28 +44,40 @@ List Pdqsort_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
 // [[Rcpp::export]]
-List Pdqsort_exsitu(NumericVector & orig) {
+List Pdqsort_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqsort_insitu(x, na_last, decreasing); });
+}
+
+template<typename T>
+List Pdqsort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   int i,n=orig.size();
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
-  for (i=0;i<n;i++)
-      aux[i] = orig[i];
-  pdqsort(aux.begin(), aux.end(), std::less<>{});
-  for (i=0;i<n;i++)
-      orig[i] = aux[i];
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (decreasing)
+    pdqsort(aux.begin(), aux.end(), std::greater<>{});
+  else
+    pdqsort(aux.begin(), aux.end(), std::less<>{});
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.0;
@@ -64,24 +86,35 @@ List Pdqsort_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
-
 // [[Rcpp::export]]
-List PdqsortB_insitu(NumericVector & orig) {
+List Pdqsort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Pdqsort_exsitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PdqsortB_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  pdqsort_branchless(orig.begin(), orig.end(), std::less<>{});
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    pdqsort_branchless(x.begin(), x.end(), std::greater<>{});
+  else
+    pdqsort_branchless(x.begin(), x.end(), std::less<>{});
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.0;
@@ -90,28 +123,40 @@ List PdqsortB_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
 // [[Rcpp::export]]
-List PdqsortB_exsitu(NumericVector & orig) {
+List PdqsortB_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PdqsortB_insitu(x, na_last, decreasing); });
+}
+
+template<typename T>
+List PdqsortB_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   int i,n=orig.size();
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
-  for (i=0;i<n;i++)
-      aux[i] = orig[i];
-  pdqsort_branchless(aux.begin(), aux.end(), std::less<>{});
-  for (i=0;i<n;i++)
-      orig[i] = aux[i];
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (decreasing)
+    pdqsort_branchless(aux.begin(), aux.end(), std::greater<>{});
+  else
+    pdqsort_branchless(aux.begin(), aux.end(), std::less<>{});
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.0;
@@ -120,5 +165,108 @@ List PdqsortB_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
+}
+
+// [[Rcpp::export]]
+List PdqsortB_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PdqsortB_exsitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PPdqsort_insitu(greensort_span<T> orig, int threads, bool branchless, bool na_last, bool decreasing) {
+  int n=orig.size();
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (branchless){
+    if (decreasing)
+      pdqsort_parallel_branchless(x.begin(), x.end(), std::greater<>{}, threads);
+    else
+      pdqsort_parallel_branchless(x.begin(), x.end(), std::less<>{}, threads);
+  }else{
+    if (decreasing)
+      pdqsort_parallel(x.begin(), x.end(), std::greater<>{}, threads);
+    else
+      pdqsort_parallel(x.begin(), x.end(), std::less<>{}, threads);
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = threads;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults);
+}
+
+// [[Rcpp::export]]
+List PPdqsort_insitu(SEXP orig, int threads, bool branchless, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PPdqsort_insitu(x, threads, branchless, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PPdqsort_exsitu(greensort_span<T> orig, int threads, bool branchless, bool na_last, bool decreasing) {
+  int i,n=orig.size();
+  NumericVector ret(10);
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (branchless){
+    if (decreasing)
+      pdqsort_parallel_branchless(aux.begin(), aux.end(), std::greater<>{}, threads);
+    else
+      pdqsort_parallel_branchless(aux.begin(), aux.end(), std::less<>{}, threads);
+  }else{
+    if (decreasing)
+      pdqsort_parallel(aux.begin(), aux.end(), std::greater<>{}, threads);
+    else
+      pdqsort_parallel(aux.begin(), aux.end(), std::less<>{}, threads);
+  }
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = threads;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults);
+}
+
+// [[Rcpp::export]]
+List PPdqsort_exsitu(SEXP orig, int threads, bool branchless, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PPdqsort_exsitu(x, threads, branchless, na_last, decreasing); });
 }
@@ -42,25 +42,86 @@
 #include <Rcpp.h>
 #include <chrono>
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 
 using namespace Rcpp;
 
+// Descending order for the peekpower sorts, which compare the elements with < only: the values are
+// viewed as Powersort_desc<T> (same layout) whose < is the > of T. Hence the strictly ascending
+// runs are reversed and equal values keep their order (stable). The +inf sentinel of the
+// non-general merging methods is the lowest value of T.
+template<class T>
+struct Powersort_desc {
+  T v;
+};
+
+template<class T>
+inline bool operator<(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return b.v < a.v; }
+template<class T>
+inline bool operator>(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return b.v > a.v; }
+template<class T>
+inline bool operator<=(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return b.v <= a.v; }
+template<class T>
+inline bool operator>=(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return b.v >= a.v; }
+template<class T>
+inline bool operator==(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return a.v == b.v; }
+template<class T>
+inline bool operator!=(const Powersort_desc<T>& a, const Powersort_desc<T>& b) { return a.v != b.v; }
+
+namespace std {
+template<class T>
+struct numeric_limits<Powersort_desc<T>> : numeric_limits<T> {
+  static Powersort_desc<T> infinity() { return Powersort_desc<T>{-numeric_limits<T>::infinity()}; }
+  static Powersort_desc<T> max() { return Powersort_desc<T>{numeric_limits<T>::lowest()}; }
+};
+}
 
- // [[Rcpp::export]]
- List gfxTimsort_insitu(NumericVector & orig) {
+template<class T>
+static inline Powersort_desc<T>* Powersort_desc_cast(T* p){
+  return reinterpret_cast<Powersort_desc<T>*>(p);
+}
+
+// The WILLEM_TUNED 4-way merge appends plus_inf_sentinel() to each run, which must be larger than
+// every value: +Inf for double but INT_MAX (a valid value) for int and int64, and for decreasing order
+// (Powersort_desc) -Inf or the lowest value. If the sentinel value occurs, the general 4-way merge
+// GENERAL_BY_STAGES is used instead (the scan is branch-free).
+template<class V>
+static void Powersort4s_sort(V* l, V* r) {
+  const V s = peekpower::plus_inf_sentinel<V>();
+  bool general = false;
+  for (V* p=l;p<r;p++)
+    general |= !(*p < s);
+  if (general)
+    std::make_unique<peekpower::powersort_4way<V *, INSERTIONSORT_LIMIT, peekpower::GENERAL_BY_STAGES, ONLYINCREASINGRUNS>>()->sort(l, r);
+  else
+    std::make_unique<peekpower::powersort_4way<V *, INSERTIONSORT_LIMIT, peekpower::WILLEM_TUNED, ONLYINCREASINGRUNS>>()->sort(l, r);
+}
+
+
+  template<typename T>
+ List gfxTimsort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   gfx::timsort(orig.begin(), orig.end());
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   if (decreasing)
+     gfx::timsort(x.begin(), x.end(), std::greater<>{});
+   else
+     gfx::timsort(x.begin(), x.end());
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 1.5;
@@ -69,29 +130,42 @@ using namespace Rcpp;
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
-
  // [[Rcpp::export]]
- List gfxTimsort_exsitu(NumericVector & orig) {
+ List gfxTimsort_insitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return gfxTimsort_insitu(x, na_last, decreasing); });
+ }
+
+
+  template<typename T>
+ List gfxTimsort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int i,n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   NumericVector aux(n);
-   for (i=0;i<n;i++)
-     aux[i] = orig[i];
-   gfx::timsort(aux.begin(), aux.end());
-   for (i=0;i<n;i++)
-     orig[i] = aux[i];
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   greensort_buffer<T> aux(false);
+   aux.resize(x.size());
+   for (i=0;i<x.size();i++)
+     aux[i] = x[i];
+   if (decreasing)
+     gfx::timsort(aux.begin(), aux.end(), std::greater<>{});
+   else
+     gfx::timsort(aux.begin(), aux.end());
+   for (i=0;i<x.size();i++)
+     x[i] = aux[i];
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 1.5;
@@ -100,26 +174,38 @@ using namespace Rcpp;
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
+ // [[Rcpp::export]]
+ List gfxTimsort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return gfxTimsort_exsitu(x, na_last, decreasing); });
+ }
 
 
 
-// [[Rcpp::export]]
-List Peeksort_insitu(NumericVector & orig) {
+
+template<typename T>
+List Peeksort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
   NumericVector ret(10);
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  std::make_unique<peekpower::peeksort<double *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(orig.begin(), orig.end());  // INSERTIONSORT_LIMIT from ordermerge.h
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    std::make_unique<peekpower::peeksort<Powersort_desc<T> *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(Powersort_desc_cast(x.begin()), Powersort_desc_cast(x.end()));
+  else
+    std::make_unique<peekpower::peeksort<T *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(x.begin(), x.end());  // INSERTIONSORT_LIMIT from ordermerge.h
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.5;
@@ -128,29 +214,42 @@ List Peeksort_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
 }
 
-
 // [[Rcpp::export]]
-List Peeksort_exsitu(NumericVector & orig) {
+List Peeksort_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Peeksort_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List Peeksort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int i,n=orig.size();
     NumericVector ret(10);
+    double alloc0 = GreensortBufferAllocSecs();
+    double faults0 = GreensortPageFaults();
     eLast = GreensortEnergyNow();
     auto start = std::chrono::high_resolution_clock::now();
-    NumericVector aux(n);
-    for (i=0;i<n;i++)
-        aux[i] = orig[i];
-    std::make_unique<peekpower::peeksort<double *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(aux.begin(), aux.end());
-    for (i=0;i<n;i++)
-        orig[i] = aux[i];
+    greensort_span<T> x = GreensortNaSplit(orig, na_last);
+    greensort_buffer<T> aux(false);
+    aux.resize(x.size());
+    for (i=0;i<x.size();i++)
+        aux[i] = x[i];
+    if (decreasing)
+      std::make_unique<peekpower::peeksort<Powersort_desc<T> *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(Powersort_desc_cast(aux.begin()), Powersort_desc_cast(aux.end()));
+    else
+      std::make_unique<peekpower::peeksort<T *, INSERTIONSORT_LIMIT, ONLYINCREASINGRUNS, peekpower::MERGINGMETHOD>>()->sort(aux.begin(), aux.end());
+    for (i=0;i<x.size();i++)
+        x[i] = aux[i];
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = 1.5;
@@ -159,26 +258,38 @@ List Peeksort_exsitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
 }
 
+// [[Rcpp::export]]
+List Peeksort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Peeksort_exsitu(x, na_last, decreasing); });
+}
 
 
 
- // [[Rcpp::export]]
- List Powersort_insitu(NumericVector & orig) {
+
+  template<typename T>
+ List Powersort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   std::make_unique<peekpower::powersort<double *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(orig.begin(), orig.end());
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   if (decreasing)
+     std::make_unique<peekpower::powersort<Powersort_desc<T> *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(Powersort_desc_cast(x.begin()), Powersort_desc_cast(x.end()));
+   else
+     std::make_unique<peekpower::powersort<T *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(x.begin(), x.end());
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 1.5;
@@ -187,29 +298,42 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
-
  // [[Rcpp::export]]
- List Powersort_exsitu(NumericVector & orig) {
+ List Powersort_insitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort_insitu(x, na_last, decreasing); });
+ }
+
+
+  template<typename T>
+ List Powersort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int i,n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   NumericVector aux(n);
-   for (i=0;i<n;i++)
-     aux[i] = orig[i];
-   std::make_unique<peekpower::powersort<double *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(aux.begin(), aux.end());
-   for (i=0;i<n;i++)
-     orig[i] = aux[i];
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   greensort_buffer<T> aux(false);
+   aux.resize(x.size());
+   for (i=0;i<x.size();i++)
+     aux[i] = x[i];
+   if (decreasing)
+     std::make_unique<peekpower::powersort<Powersort_desc<T> *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(Powersort_desc_cast(aux.begin()), Powersort_desc_cast(aux.end()));
+   else
+     std::make_unique<peekpower::powersort<T *, INSERTIONSORT_LIMIT, peekpower::MERGINGMETHOD, ONLYINCREASINGRUNS>>()->sort(aux.begin(), aux.end());
+   for (i=0;i<x.size();i++)
+     x[i] = aux[i];
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 1.5;
@@ -218,26 +342,38 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+ }
+
+ // [[Rcpp::export]]
+ List Powersort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort_exsitu(x, na_last, decreasing); });
  }
 
 
 
 
- // [[Rcpp::export]]
- List Powersort4_insitu(NumericVector & orig) {
+  template<typename T>
+ List Powersort4_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   std::make_unique<peekpower::powersort_4way<double *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(orig.begin(), orig.end());
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   if (decreasing)
+     std::make_unique<peekpower::powersort_4way<Powersort_desc<T> *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(Powersort_desc_cast(x.begin()), Powersort_desc_cast(x.end()));
+   else
+     std::make_unique<peekpower::powersort_4way<T *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(x.begin(), x.end());
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 2.0;
@@ -246,29 +382,42 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
-
  // [[Rcpp::export]]
- List Powersort4_exsitu(NumericVector & orig) {
+ List Powersort4_insitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort4_insitu(x, na_last, decreasing); });
+ }
+
+
+  template<typename T>
+ List Powersort4_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int i,n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   NumericVector aux(n);
-   for (i=0;i<n;i++)
-     aux[i] = orig[i];
-   std::make_unique<peekpower::powersort_4way<double *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(aux.begin(), aux.end());
-   for (i=0;i<n;i++)
-     orig[i] = aux[i];
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   greensort_buffer<T> aux(false);
+   aux.resize(x.size());
+   for (i=0;i<x.size();i++)
+     aux[i] = x[i];
+   if (decreasing)
+     std::make_unique<peekpower::powersort_4way<Powersort_desc<T> *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(Powersort_desc_cast(aux.begin()), Powersort_desc_cast(aux.end()));
+   else
+     std::make_unique<peekpower::powersort_4way<T *, INSERTIONSORT_LIMIT, peekpower::MERGING4WAYMETHOD, ONLYINCREASINGRUNS>>()->sort(aux.begin(), aux.end());
+   for (i=0;i<x.size();i++)
+     x[i] = aux[i];
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 2.0;
@@ -277,25 +426,37 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
+ // [[Rcpp::export]]
+ List Powersort4_exsitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort4_exsitu(x, na_last, decreasing); });
+ }
 
 
- // [[Rcpp::export]]
- List Powersort4s_insitu(NumericVector & orig) {
+
+  template<typename T>
+ List Powersort4s_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
    int n=orig.size();
    NumericVector ret(10);
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   std::make_unique<peekpower::powersort_4way<double *, INSERTIONSORT_LIMIT, peekpower::WILLEM_TUNED, ONLYINCREASINGRUNS>>()->sort(orig.begin(), orig.end());
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   if (decreasing)
+     Powersort4s_sort(Powersort_desc_cast(x.begin()), Powersort_desc_cast(x.end()));
+   else
+     Powersort4s_sort(x.begin(), x.end());
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 2.0;
@@ -304,29 +465,42 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
  }
 
-
  // [[Rcpp::export]]
- List Powersort4s_exsitu(NumericVector & orig) {
+ List Powersort4s_insitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort4s_insitu(x, na_last, decreasing); });
+ }
+
+
+  template<typename T>
+ List Powersort4s_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
    int i,n=orig.size();
    NumericVector ret(10);
    PCapEnergyT eLast;
    GreensortEnergyT eNext;
+   double alloc0 = GreensortBufferAllocSecs();
+   double faults0 = GreensortPageFaults();
    eLast = GreensortEnergyNow();
    auto start = std::chrono::high_resolution_clock::now();
-   NumericVector aux(n);
-   for (i=0;i<n;i++)
-     aux[i] = orig[i];
-   std::make_unique<peekpower::powersort_4way<double *, INSERTIONSORT_LIMIT, peekpower::WILLEM_TUNED, ONLYINCREASINGRUNS>>()->sort(orig.begin(), orig.end());
-   for (i=0;i<n;i++)
-     orig[i] = aux[i];
+   greensort_span<T> x = GreensortNaSplit(orig, na_last);
+   greensort_buffer<T> aux(false);
+   aux.resize(x.size());
+   for (i=0;i<x.size();i++)
+     aux[i] = x[i];
+   if (decreasing)
+     Powersort4s_sort(Powersort_desc_cast(aux.begin()), Powersort_desc_cast(aux.end()));
+   else
+     Powersort4s_sort(aux.begin(), aux.end());
+   for (i=0;i<x.size();i++)
+     x[i] = aux[i];
    auto stop = std::chrono::high_resolution_clock::now();
    eNext = GreensortEnergyDelta(&eLast);
+   double faults = GreensortPageFaults() - faults0;
    auto diff = stop - start;
    ret[0] = n;
-   ret[1] = 8;
+   ret[1] = sizeof(T);
    ret[2] = 1;
    ret[3] = 1;
    ret[4] = 2.0;
@@ -335,5 +509,10 @@ List Peeksort_exsitu(NumericVector & orig) {
    ret[7] = eNext.core;
    ret[8] = eNext.unco;
    ret[9] = eNext.dram;
-   return List::create(Named("ret") = ret);
+   return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+ }
+
+ // [[Rcpp::export]]
+ List Powersort4s_exsitu(SEXP orig, bool na_last, bool decreasing) {
+   return GreensortDispatch(orig, [&](auto x){ return Powersort4s_exsitu(x, na_last, decreasing); });
  }
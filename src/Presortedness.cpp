@@ -0,0 +1,37 @@
+/*
+# Code for interfacing and timing the presortedness profiler
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+#include <Rcpp.h>
+#include <chrono>
+#include "sort_types.h"
+#include "sort_profile.h"
+
+using namespace Rcpp;
+
+template<typename T>
+NumericVector Presortedness_sample(greensort_span<T> x, int sample) {
+  auto start = std::chrono::high_resolution_clock::now();
+  GreensortProfile p = GreensortPresortedness(x.begin(), x.size(), (size_t) sample);
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto diff = stop - start;
+  return NumericVector::create(
+    Named("n") = p.n
+  , Named("b") = (double) sizeof(T)
+  , Named("na") = p.na
+  , Named("runs") = p.runs
+  , Named("runlen") = p.runlen
+  , Named("inversions") = p.inversions
+  , Named("duplicates") = p.duplicates
+  , Named("entropy") = p.entropy
+  , Named("secs") = std::chrono::duration <double, std::ratio<1,1>> (diff).count()
+  );
+}
+
+// [[Rcpp::export]]
+NumericVector Presortedness_sample(SEXP x, int sample) {
+  return GreensortDispatch(x, [&](auto v){ return Presortedness_sample(v, sample); });
+}
@@ -10,324 +10,884 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// BufferCache_warm
+double BufferCache_warm(double bytes, int count);
+RcppExport SEXP _greeNsort_Rcpp_BufferCache_warm(SEXP bytesSEXP, SEXP countSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type bytes(bytesSEXP);
+    Rcpp::traits::input_parameter< int >::type count(countSEXP);
+    rcpp_result_gen = Rcpp::wrap(BufferCache_warm(bytes, count));
+    return rcpp_result_gen;
+END_RCPP
+}
+// BufferCache_limit
+double BufferCache_limit(double limit);
+RcppExport SEXP _greeNsort_Rcpp_BufferCache_limit(SEXP limitSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type limit(limitSEXP);
+    rcpp_result_gen = Rcpp::wrap(BufferCache_limit(limit));
+    return rcpp_result_gen;
+END_RCPP
+}
+// BufferCache_policy
+int BufferCache_policy(int policy);
+RcppExport SEXP _greeNsort_Rcpp_BufferCache_policy(SEXP policySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type policy(policySEXP);
+    rcpp_result_gen = Rcpp::wrap(BufferCache_policy(policy));
+    return rcpp_result_gen;
+END_RCPP
+}
+// BufferCache_release
+double BufferCache_release();
+RcppExport SEXP _greeNsort_Rcpp_BufferCache_release() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(BufferCache_release());
+    return rcpp_result_gen;
+END_RCPP
+}
+// BufferCache_info
+List BufferCache_info();
+RcppExport SEXP _greeNsort_Rcpp_BufferCache_info() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(BufferCache_info());
+    return rcpp_result_gen;
+END_RCPP
+}
+// Cosort_engine
+List Cosort_engine(SEXP orig, List payload, int engine, int threads);
+RcppExport SEXP _greeNsort_Rcpp_Cosort_engine(SEXP origSEXP, SEXP payloadSEXP, SEXP engineSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< List >::type payload(payloadSEXP);
+    Rcpp::traits::input_parameter< int >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(Cosort_engine(orig, payload, engine, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Extsort_files
+List Extsort_files(std::string infile, std::string outfile, std::string type, double budget, int fanin, int engine, int threads, bool na_last, bool decreasing, std::string tmpdir, bool direct);
+RcppExport SEXP _greeNsort_Rcpp_Extsort_files(SEXP infileSEXP, SEXP outfileSEXP, SEXP typeSEXP, SEXP budgetSEXP, SEXP faninSEXP, SEXP engineSEXP, SEXP threadsSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP, SEXP tmpdirSEXP, SEXP directSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type infile(infileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outfile(outfileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< double >::type budget(budgetSEXP);
+    Rcpp::traits::input_parameter< int >::type fanin(faninSEXP);
+    Rcpp::traits::input_parameter< int >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    Rcpp::traits::input_parameter< std::string >::type tmpdir(tmpdirSEXP);
+    Rcpp::traits::input_parameter< bool >::type direct(directSEXP);
+    rcpp_result_gen = Rcpp::wrap(Extsort_files(infile, outfile, type, budget, fanin, engine, threads, na_last, decreasing, tmpdir, direct));
+    return rcpp_result_gen;
+END_RCPP
+}
 // IPS4o_insitu
-List IPS4o_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_IPS4o_insitu(SEXP origSEXP) {
+List IPS4o_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_IPS4o_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(IPS4o_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(IPS4o_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // IPS4o_exsitu
-List IPS4o_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_IPS4o_exsitu(SEXP origSEXP) {
+List IPS4o_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_IPS4o_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(IPS4o_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(IPS4o_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // IS4o_insitu
-List IS4o_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_IS4o_insitu(SEXP origSEXP) {
+List IS4o_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_IS4o_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(IS4o_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(IS4o_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // IS4o_exsitu
-List IS4o_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_IS4o_exsitu(SEXP origSEXP) {
+List IS4o_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_IS4o_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(IS4o_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(IS4o_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Learnsort_insitu
-List Learnsort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Learnsort_insitu(SEXP origSEXP) {
+List Learnsort_insitu(SEXP orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_insitu(SEXP origSEXP, SEXP sampling_rateSEXP, SEXP overallocationSEXP, SEXP fanoutSEXP, SEXP batch_szSEXP, SEXP thresholdSEXP, SEXP autotuneSEXP, SEXP robustSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Learnsort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< double >::type sampling_rate(sampling_rateSEXP);
+    Rcpp::traits::input_parameter< double >::type overallocation(overallocationSEXP);
+    Rcpp::traits::input_parameter< int >::type fanout(fanoutSEXP);
+    Rcpp::traits::input_parameter< int >::type batch_sz(batch_szSEXP);
+    Rcpp::traits::input_parameter< int >::type threshold(thresholdSEXP);
+    Rcpp::traits::input_parameter< bool >::type autotune(autotuneSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_insitu(orig, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune, robust, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Learnsort_exsitu
-List Learnsort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Learnsort_exsitu(SEXP origSEXP) {
+List Learnsort_exsitu(SEXP orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune, bool robust, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_exsitu(SEXP origSEXP, SEXP sampling_rateSEXP, SEXP overallocationSEXP, SEXP fanoutSEXP, SEXP batch_szSEXP, SEXP thresholdSEXP, SEXP autotuneSEXP, SEXP robustSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< double >::type sampling_rate(sampling_rateSEXP);
+    Rcpp::traits::input_parameter< double >::type overallocation(overallocationSEXP);
+    Rcpp::traits::input_parameter< int >::type fanout(fanoutSEXP);
+    Rcpp::traits::input_parameter< int >::type batch_sz(batch_szSEXP);
+    Rcpp::traits::input_parameter< int >::type threshold(thresholdSEXP);
+    Rcpp::traits::input_parameter< bool >::type autotune(autotuneSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_exsitu(orig, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune, robust, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Learnsort_train
+SEXP Learnsort_train(NumericVector& orig, double sampling_rate, double overallocation, int fanout, int batch_sz, int threshold, bool autotune);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_train(SEXP origSEXP, SEXP sampling_rateSEXP, SEXP overallocationSEXP, SEXP fanoutSEXP, SEXP batch_szSEXP, SEXP thresholdSEXP, SEXP autotuneSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Learnsort_exsitu(orig));
+    Rcpp::traits::input_parameter< double >::type sampling_rate(sampling_rateSEXP);
+    Rcpp::traits::input_parameter< double >::type overallocation(overallocationSEXP);
+    Rcpp::traits::input_parameter< int >::type fanout(fanoutSEXP);
+    Rcpp::traits::input_parameter< int >::type batch_sz(batch_szSEXP);
+    Rcpp::traits::input_parameter< int >::type threshold(thresholdSEXP);
+    Rcpp::traits::input_parameter< bool >::type autotune(autotuneSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_train(orig, sampling_rate, overallocation, fanout, batch_sz, threshold, autotune));
     return rcpp_result_gen;
 END_RCPP
 }
-// Pdqsort_insitu
-List Pdqsort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Pdqsort_insitu(SEXP origSEXP) {
+// Learnsort_model_insitu
+List Learnsort_model_insitu(NumericVector& orig, SEXP model, double drift, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_model_insitu(SEXP origSEXP, SEXP modelSEXP, SEXP driftSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Pdqsort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< double >::type drift(driftSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_model_insitu(orig, model, drift, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
-// Pdqsort_exsitu
-List Pdqsort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Pdqsort_exsitu(SEXP origSEXP) {
+// Learnsort_model_exsitu
+List Learnsort_model_exsitu(NumericVector& orig, SEXP model, double drift, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_model_exsitu(SEXP origSEXP, SEXP modelSEXP, SEXP driftSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Pdqsort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< double >::type drift(driftSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_model_exsitu(orig, model, drift, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Learnsort_serialize
+NumericVector Learnsort_serialize(SEXP model);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_serialize(SEXP modelSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_serialize(model));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Learnsort_unserialize
+SEXP Learnsort_unserialize(NumericVector& v);
+RcppExport SEXP _greeNsort_Rcpp_Learnsort_unserialize(SEXP vSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type v(vSEXP);
+    rcpp_result_gen = Rcpp::wrap(Learnsort_unserialize(v));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PLearnsort_insitu
+List PLearnsort_insitu(SEXP orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PLearnsort_insitu(SEXP origSEXP, SEXP threadsSEXP, SEXP sampling_rateSEXP, SEXP fanoutSEXP, SEXP autotuneSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type sampling_rate(sampling_rateSEXP);
+    Rcpp::traits::input_parameter< int >::type fanout(fanoutSEXP);
+    Rcpp::traits::input_parameter< bool >::type autotune(autotuneSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PLearnsort_insitu(orig, threads, sampling_rate, fanout, autotune, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PLearnsort_exsitu
+List PLearnsort_exsitu(SEXP orig, int threads, double sampling_rate, int fanout, bool autotune, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PLearnsort_exsitu(SEXP origSEXP, SEXP threadsSEXP, SEXP sampling_rateSEXP, SEXP fanoutSEXP, SEXP autotuneSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type sampling_rate(sampling_rateSEXP);
+    Rcpp::traits::input_parameter< int >::type fanout(fanoutSEXP);
+    Rcpp::traits::input_parameter< bool >::type autotune(autotuneSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PLearnsort_exsitu(orig, threads, sampling_rate, fanout, autotune, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Order_engine
+List Order_engine(SEXP orig, int engine, int threads);
+RcppExport SEXP _greeNsort_Rcpp_Order_engine(SEXP origSEXP, SEXP engineSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(Order_engine(orig, engine, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// OrderMulti_engine
+List OrderMulti_engine(List x, LogicalVector decreasing, LogicalVector na_last, int threads);
+RcppExport SEXP _greeNsort_Rcpp_OrderMulti_engine(SEXP xSEXP, SEXP decreasingSEXP, SEXP na_lastSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type x(xSEXP);
+    Rcpp::traits::input_parameter< LogicalVector >::type decreasing(decreasingSEXP);
+    Rcpp::traits::input_parameter< LogicalVector >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(OrderMulti_engine(x, decreasing, na_last, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqselect_insitu
+List Pdqselect_insitu(SEXP orig, IntegerVector& k);
+RcppExport SEXP _greeNsort_Rcpp_Pdqselect_insitu(SEXP origSEXP, SEXP kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type k(kSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqselect_insitu(orig, k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqselect_exsitu
+List Pdqselect_exsitu(SEXP orig, IntegerVector& k);
+RcppExport SEXP _greeNsort_Rcpp_Pdqselect_exsitu(SEXP origSEXP, SEXP kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type k(kSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqselect_exsitu(orig, k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqpartial_insitu
+List Pdqpartial_insitu(SEXP orig, int k, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Pdqpartial_insitu(SEXP origSEXP, SEXP kSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqpartial_insitu(orig, k, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqpartial_exsitu
+List Pdqpartial_exsitu(SEXP orig, int k, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Pdqpartial_exsitu(SEXP origSEXP, SEXP kSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqpartial_exsitu(orig, k, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqsort_insitu
+List Pdqsort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Pdqsort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqsort_insitu(orig, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Pdqsort_exsitu
+List Pdqsort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Pdqsort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Pdqsort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // PdqsortB_insitu
-List PdqsortB_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_PdqsortB_insitu(SEXP origSEXP) {
+List PdqsortB_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PdqsortB_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(PdqsortB_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PdqsortB_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // PdqsortB_exsitu
-List PdqsortB_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_PdqsortB_exsitu(SEXP origSEXP) {
+List PdqsortB_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PdqsortB_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(PdqsortB_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PdqsortB_exsitu(orig, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PPdqsort_insitu
+List PPdqsort_insitu(SEXP orig, int threads, bool branchless, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PPdqsort_insitu(SEXP origSEXP, SEXP threadsSEXP, SEXP branchlessSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type branchless(branchlessSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PPdqsort_insitu(orig, threads, branchless, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PPdqsort_exsitu
+List PPdqsort_exsitu(SEXP orig, int threads, bool branchless, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PPdqsort_exsitu(SEXP origSEXP, SEXP threadsSEXP, SEXP branchlessSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type branchless(branchlessSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PPdqsort_exsitu(orig, threads, branchless, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // gfxTimsort_insitu
-List gfxTimsort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_gfxTimsort_insitu(SEXP origSEXP) {
+List gfxTimsort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_gfxTimsort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(gfxTimsort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(gfxTimsort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // gfxTimsort_exsitu
-List gfxTimsort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_gfxTimsort_exsitu(SEXP origSEXP) {
+List gfxTimsort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_gfxTimsort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(gfxTimsort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(gfxTimsort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Peeksort_insitu
-List Peeksort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Peeksort_insitu(SEXP origSEXP) {
+List Peeksort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Peeksort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Peeksort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Peeksort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Peeksort_exsitu
-List Peeksort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Peeksort_exsitu(SEXP origSEXP) {
+List Peeksort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Peeksort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Peeksort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Peeksort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort_insitu
-List Powersort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort_insitu(SEXP origSEXP) {
+List Powersort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort_exsitu
-List Powersort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort_exsitu(SEXP origSEXP) {
+List Powersort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort4_insitu
-List Powersort4_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort4_insitu(SEXP origSEXP) {
+List Powersort4_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort4_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort4_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort4_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort4_exsitu
-List Powersort4_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort4_exsitu(SEXP origSEXP) {
+List Powersort4_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort4_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort4_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort4_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort4s_insitu
-List Powersort4s_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort4s_insitu(SEXP origSEXP) {
+List Powersort4s_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort4s_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort4s_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort4s_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Powersort4s_exsitu
-List Powersort4s_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Powersort4s_exsitu(SEXP origSEXP) {
+List Powersort4s_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Powersort4s_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Powersort4s_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Powersort4s_exsitu(orig, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Presortedness_sample
+NumericVector Presortedness_sample(SEXP x, int sample);
+RcppExport SEXP _greeNsort_Rcpp_Presortedness_sample(SEXP xSEXP, SEXP sampleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type sample(sampleSEXP);
+    rcpp_result_gen = Rcpp::wrap(Presortedness_sample(x, sample));
     return rcpp_result_gen;
 END_RCPP
 }
 // Skasort_insitu
-List Skasort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Skasort_insitu(SEXP origSEXP) {
+List Skasort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Skasort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Skasort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Skasort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Skasort_exsitu
-List Skasort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Skasort_exsitu(SEXP origSEXP) {
+List Skasort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Skasort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Skasort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Skasort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // ISkasort_insitu
-List ISkasort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_ISkasort_insitu(SEXP origSEXP) {
+List ISkasort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_ISkasort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(ISkasort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(ISkasort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // ISkasort_exsitu
-List ISkasort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_ISkasort_exsitu(SEXP origSEXP) {
+List ISkasort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_ISkasort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(ISkasort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(ISkasort_exsitu(orig, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Sorted_wrap
+SEXP Sorted_wrap(SEXP x, bool decreasing, bool na_last);
+RcppExport SEXP _greeNsort_Rcpp_Sorted_wrap(SEXP xSEXP, SEXP decreasingSEXP, SEXP na_lastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    rcpp_result_gen = Rcpp::wrap(Sorted_wrap(x, decreasing, na_last));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Sortfile_mmap
+List Sortfile_mmap(std::string path, std::string type, int engine, int threads, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Sortfile_mmap(SEXP pathSEXP, SEXP typeSEXP, SEXP engineSEXP, SEXP threadsSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< int >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Sortfile_mmap(path, type, engine, threads, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Streamsort_new
+SEXP Streamsort_new(int engine, int threads, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Streamsort_new(SEXP engineSEXP, SEXP threadsSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Streamsort_new(engine, threads, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Streamsort_push
+List Streamsort_push(SEXP stream, SEXP chunk);
+RcppExport SEXP _greeNsort_Rcpp_Streamsort_push(SEXP streamSEXP, SEXP chunkSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type chunk(chunkSEXP);
+    rcpp_result_gen = Rcpp::wrap(Streamsort_push(stream, chunk));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Streamsort_finish
+double Streamsort_finish(SEXP stream);
+RcppExport SEXP _greeNsort_Rcpp_Streamsort_finish(SEXP streamSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    rcpp_result_gen = Rcpp::wrap(Streamsort_finish(stream));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Streamsort_next
+SEXP Streamsort_next(SEXP stream, double k);
+RcppExport SEXP _greeNsort_Rcpp_Streamsort_next(SEXP streamSEXP, SEXP kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< double >::type k(kSEXP);
+    rcpp_result_gen = Rcpp::wrap(Streamsort_next(stream, k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Strsort_insitu
+List Strsort_insitu(SEXP orig, bool cache);
+RcppExport SEXP _greeNsort_Rcpp_Strsort_insitu(SEXP origSEXP, SEXP cacheSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type cache(cacheSEXP);
+    rcpp_result_gen = Rcpp::wrap(Strsort_insitu(orig, cache));
     return rcpp_result_gen;
 END_RCPP
 }
 // Timsort_insitu
-List Timsort_insitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Timsort_insitu(SEXP origSEXP) {
+List Timsort_insitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Timsort_insitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Timsort_insitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Timsort_insitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
 // Timsort_exsitu
-List Timsort_exsitu(NumericVector& orig);
-RcppExport SEXP _greeNsort_Rcpp_Timsort_exsitu(SEXP origSEXP) {
+List Timsort_exsitu(SEXP orig, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_Timsort_exsitu(SEXP origSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type orig(origSEXP);
-    rcpp_result_gen = Rcpp::wrap(Timsort_exsitu(orig));
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(Timsort_exsitu(orig, na_last, decreasing));
     return rcpp_result_gen;
 END_RCPP
 }
+// PTimsort_insitu
+List PTimsort_insitu(SEXP orig, int threads, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PTimsort_insitu(SEXP origSEXP, SEXP threadsSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PTimsort_insitu(orig, threads, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PTimsort_exsitu
+List PTimsort_exsitu(SEXP orig, int threads, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_PTimsort_exsitu(SEXP origSEXP, SEXP threadsSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(PTimsort_exsitu(orig, threads, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// TimsortPre_insitu
+List TimsortPre_insitu(SEXP orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_TimsortPre_insitu(SEXP origSEXP, SEXP scratchSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type scratch(scratchSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(TimsortPre_insitu(orig, scratch, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+// TimsortPre_exsitu
+List TimsortPre_exsitu(SEXP orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing);
+RcppExport SEXP _greeNsort_Rcpp_TimsortPre_exsitu(SEXP origSEXP, SEXP scratchSEXP, SEXP na_lastSEXP, SEXP decreasingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type orig(origSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type scratch(scratchSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_last(na_lastSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    rcpp_result_gen = Rcpp::wrap(TimsortPre_exsitu(orig, scratch, na_last, decreasing));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+void Sorted_init(DllInfo* dll);
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_greeNsort_Rcpp_IPS4o_insitu", (DL_FUNC) &_greeNsort_Rcpp_IPS4o_insitu, 1},
-    {"_greeNsort_Rcpp_IPS4o_exsitu", (DL_FUNC) &_greeNsort_Rcpp_IPS4o_exsitu, 1},
-    {"_greeNsort_Rcpp_IS4o_insitu", (DL_FUNC) &_greeNsort_Rcpp_IS4o_insitu, 1},
-    {"_greeNsort_Rcpp_IS4o_exsitu", (DL_FUNC) &_greeNsort_Rcpp_IS4o_exsitu, 1},
-    {"_greeNsort_Rcpp_Learnsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_insitu, 1},
-    {"_greeNsort_Rcpp_Learnsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_exsitu, 1},
-    {"_greeNsort_Rcpp_Pdqsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqsort_insitu, 1},
-    {"_greeNsort_Rcpp_Pdqsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqsort_exsitu, 1},
-    {"_greeNsort_Rcpp_PdqsortB_insitu", (DL_FUNC) &_greeNsort_Rcpp_PdqsortB_insitu, 1},
-    {"_greeNsort_Rcpp_PdqsortB_exsitu", (DL_FUNC) &_greeNsort_Rcpp_PdqsortB_exsitu, 1},
-    {"_greeNsort_Rcpp_gfxTimsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_gfxTimsort_insitu, 1},
-    {"_greeNsort_Rcpp_gfxTimsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_gfxTimsort_exsitu, 1},
-    {"_greeNsort_Rcpp_Peeksort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Peeksort_insitu, 1},
-    {"_greeNsort_Rcpp_Peeksort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Peeksort_exsitu, 1},
-    {"_greeNsort_Rcpp_Powersort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort_insitu, 1},
-    {"_greeNsort_Rcpp_Powersort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort_exsitu, 1},
-    {"_greeNsort_Rcpp_Powersort4_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4_insitu, 1},
-    {"_greeNsort_Rcpp_Powersort4_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4_exsitu, 1},
-    {"_greeNsort_Rcpp_Powersort4s_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4s_insitu, 1},
-    {"_greeNsort_Rcpp_Powersort4s_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4s_exsitu, 1},
-    {"_greeNsort_Rcpp_Skasort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Skasort_insitu, 1},
-    {"_greeNsort_Rcpp_Skasort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Skasort_exsitu, 1},
-    {"_greeNsort_Rcpp_ISkasort_insitu", (DL_FUNC) &_greeNsort_Rcpp_ISkasort_insitu, 1},
-    {"_greeNsort_Rcpp_ISkasort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_ISkasort_exsitu, 1},
-    {"_greeNsort_Rcpp_Timsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Timsort_insitu, 1},
-    {"_greeNsort_Rcpp_Timsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Timsort_exsitu, 1},
+    {"_greeNsort_Rcpp_BufferCache_warm", (DL_FUNC) &_greeNsort_Rcpp_BufferCache_warm, 2},
+    {"_greeNsort_Rcpp_BufferCache_limit", (DL_FUNC) &_greeNsort_Rcpp_BufferCache_limit, 1},
+    {"_greeNsort_Rcpp_BufferCache_policy", (DL_FUNC) &_greeNsort_Rcpp_BufferCache_policy, 1},
+    {"_greeNsort_Rcpp_BufferCache_release", (DL_FUNC) &_greeNsort_Rcpp_BufferCache_release, 0},
+    {"_greeNsort_Rcpp_BufferCache_info", (DL_FUNC) &_greeNsort_Rcpp_BufferCache_info, 0},
+    {"_greeNsort_Rcpp_Cosort_engine", (DL_FUNC) &_greeNsort_Rcpp_Cosort_engine, 4},
+    {"_greeNsort_Rcpp_Extsort_files", (DL_FUNC) &_greeNsort_Rcpp_Extsort_files, 11},
+    {"_greeNsort_Rcpp_IPS4o_insitu", (DL_FUNC) &_greeNsort_Rcpp_IPS4o_insitu, 3},
+    {"_greeNsort_Rcpp_IPS4o_exsitu", (DL_FUNC) &_greeNsort_Rcpp_IPS4o_exsitu, 3},
+    {"_greeNsort_Rcpp_IS4o_insitu", (DL_FUNC) &_greeNsort_Rcpp_IS4o_insitu, 3},
+    {"_greeNsort_Rcpp_IS4o_exsitu", (DL_FUNC) &_greeNsort_Rcpp_IS4o_exsitu, 3},
+    {"_greeNsort_Rcpp_Learnsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_insitu, 10},
+    {"_greeNsort_Rcpp_Learnsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_exsitu, 10},
+    {"_greeNsort_Rcpp_Learnsort_train", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_train, 7},
+    {"_greeNsort_Rcpp_Learnsort_model_insitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_model_insitu, 5},
+    {"_greeNsort_Rcpp_Learnsort_model_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_model_exsitu, 5},
+    {"_greeNsort_Rcpp_Learnsort_serialize", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_serialize, 1},
+    {"_greeNsort_Rcpp_Learnsort_unserialize", (DL_FUNC) &_greeNsort_Rcpp_Learnsort_unserialize, 1},
+    {"_greeNsort_Rcpp_PLearnsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_PLearnsort_insitu, 7},
+    {"_greeNsort_Rcpp_PLearnsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_PLearnsort_exsitu, 7},
+    {"_greeNsort_Rcpp_Order_engine", (DL_FUNC) &_greeNsort_Rcpp_Order_engine, 3},
+    {"_greeNsort_Rcpp_OrderMulti_engine", (DL_FUNC) &_greeNsort_Rcpp_OrderMulti_engine, 4},
+    {"_greeNsort_Rcpp_Pdqselect_insitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqselect_insitu, 2},
+    {"_greeNsort_Rcpp_Pdqselect_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqselect_exsitu, 2},
+    {"_greeNsort_Rcpp_Pdqpartial_insitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqpartial_insitu, 3},
+    {"_greeNsort_Rcpp_Pdqpartial_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqpartial_exsitu, 3},
+    {"_greeNsort_Rcpp_Pdqsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqsort_insitu, 3},
+    {"_greeNsort_Rcpp_Pdqsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Pdqsort_exsitu, 3},
+    {"_greeNsort_Rcpp_PdqsortB_insitu", (DL_FUNC) &_greeNsort_Rcpp_PdqsortB_insitu, 3},
+    {"_greeNsort_Rcpp_PdqsortB_exsitu", (DL_FUNC) &_greeNsort_Rcpp_PdqsortB_exsitu, 3},
+    {"_greeNsort_Rcpp_PPdqsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_PPdqsort_insitu, 5},
+    {"_greeNsort_Rcpp_PPdqsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_PPdqsort_exsitu, 5},
+    {"_greeNsort_Rcpp_gfxTimsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_gfxTimsort_insitu, 3},
+    {"_greeNsort_Rcpp_gfxTimsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_gfxTimsort_exsitu, 3},
+    {"_greeNsort_Rcpp_Peeksort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Peeksort_insitu, 3},
+    {"_greeNsort_Rcpp_Peeksort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Peeksort_exsitu, 3},
+    {"_greeNsort_Rcpp_Powersort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort_insitu, 3},
+    {"_greeNsort_Rcpp_Powersort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort_exsitu, 3},
+    {"_greeNsort_Rcpp_Powersort4_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4_insitu, 3},
+    {"_greeNsort_Rcpp_Powersort4_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4_exsitu, 3},
+    {"_greeNsort_Rcpp_Powersort4s_insitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4s_insitu, 3},
+    {"_greeNsort_Rcpp_Powersort4s_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Powersort4s_exsitu, 3},
+    {"_greeNsort_Rcpp_Presortedness_sample", (DL_FUNC) &_greeNsort_Rcpp_Presortedness_sample, 2},
+    {"_greeNsort_Rcpp_Skasort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Skasort_insitu, 3},
+    {"_greeNsort_Rcpp_Skasort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Skasort_exsitu, 3},
+    {"_greeNsort_Rcpp_ISkasort_insitu", (DL_FUNC) &_greeNsort_Rcpp_ISkasort_insitu, 3},
+    {"_greeNsort_Rcpp_ISkasort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_ISkasort_exsitu, 3},
+    {"_greeNsort_Rcpp_Sorted_wrap", (DL_FUNC) &_greeNsort_Rcpp_Sorted_wrap, 3},
+    {"_greeNsort_Rcpp_Sortfile_mmap", (DL_FUNC) &_greeNsort_Rcpp_Sortfile_mmap, 6},
+    {"_greeNsort_Rcpp_Streamsort_new", (DL_FUNC) &_greeNsort_Rcpp_Streamsort_new, 4},
+    {"_greeNsort_Rcpp_Streamsort_push", (DL_FUNC) &_greeNsort_Rcpp_Streamsort_push, 2},
+    {"_greeNsort_Rcpp_Streamsort_finish", (DL_FUNC) &_greeNsort_Rcpp_Streamsort_finish, 1},
+    {"_greeNsort_Rcpp_Streamsort_next", (DL_FUNC) &_greeNsort_Rcpp_Streamsort_next, 2},
+    {"_greeNsort_Rcpp_Strsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Strsort_insitu, 2},
+    {"_greeNsort_Rcpp_Timsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_Timsort_insitu, 3},
+    {"_greeNsort_Rcpp_Timsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_Timsort_exsitu, 3},
+    {"_greeNsort_Rcpp_PTimsort_insitu", (DL_FUNC) &_greeNsort_Rcpp_PTimsort_insitu, 4},
+    {"_greeNsort_Rcpp_PTimsort_exsitu", (DL_FUNC) &_greeNsort_Rcpp_PTimsort_exsitu, 4},
+    {"_greeNsort_Rcpp_TimsortPre_insitu", (DL_FUNC) &_greeNsort_Rcpp_TimsortPre_insitu, 4},
+    {"_greeNsort_Rcpp_TimsortPre_exsitu", (DL_FUNC) &_greeNsort_Rcpp_TimsortPre_exsitu, 4},
     {NULL, NULL, 0}
 };
 
 RcppExport void R_init_greeNsort_Rcpp(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    Sorted_init(dll);
 }
@@ -10,6 +10,9 @@
 #include "ska/ska_sort.hpp"
 #include <chrono>
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 using namespace Rcpp;
 
@@ -41,22 +44,26 @@ static void inplace_radix_sort(It begin, It end)
 
 
 
-// [[Rcpp::export]]
-List Skasort_insitu(NumericVector & orig) {
+template<typename T>
+List Skasort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   NumericVector ret(10);
   int n=orig.size();
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector buf(n);
-  bool which = radix_sort(orig.begin(), orig.end(), buf.begin());
+  GreensortRadixKey key(na_last, decreasing);
+  greensort_buffer<T> buf;
+  buf.resize(n);
+  bool which = radix_sort(orig.begin(), orig.end(), buf.begin(), key);
   //STABLE_TEST_PSEUDO_ROUND: bool which = radix_sort(orig.begin(), orig.end(), buf.begin(), [](auto i){ return floor(i); });
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 2.0;
@@ -65,30 +72,40 @@ List Skasort_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
-
 // [[Rcpp::export]]
-List Skasort_exsitu(NumericVector & orig) {
+List Skasort_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Skasort_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List Skasort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   int i,n=orig.size();
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
+  GreensortRadixKey key(na_last, decreasing);
+  greensort_buffer<T> aux(false);
+  aux.resize(n);
   for (i=0;i<n;i++)
       aux[i] = orig[i];
-  NumericVector buf(n);
-  bool which = radix_sort(aux.begin(), aux.end(), buf.begin());
+  greensort_buffer<T> buf(false);
+  buf.resize(n);
+  bool which = radix_sort(aux.begin(), aux.end(), buf.begin(), key);
   for (i=0;i<n;i++)
       orig[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 2.0;
@@ -97,26 +114,34 @@ List Skasort_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
+// [[Rcpp::export]]
+List Skasort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Skasort_exsitu(x, na_last, decreasing); });
+}
 
 
-// [[Rcpp::export]]
-List ISkasort_insitu(NumericVector & orig) {
+
+template<typename T>
+List ISkasort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
   NumericVector ret(10);
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-    inplace_radix_sort(orig.begin(), orig.end());
+    GreensortRadixKey key(na_last, decreasing);
+    inplace_radix_sort(orig.begin(), orig.end(), key);
     //STABLE_TEST_PSEUDO_ROUND - IS STABLE: inplace_radix_sort(orig.begin(), orig.end(), [](auto i){ return floor(i); });
     auto stop = std::chrono::high_resolution_clock::now();
     eNext = GreensortEnergyDelta(&eLast);
+    double faults = GreensortPageFaults() - faults0;
     auto diff = stop - start;
     ret[0] = n;
-    ret[1] = 8;
+    ret[1] = sizeof(T);
     ret[2] = 1;
     ret[3] = 1;
     ret[4] = 2.0;
@@ -125,30 +150,39 @@ List ISkasort_insitu(NumericVector & orig) {
     ret[7] = eNext.core;
     ret[8] = eNext.unco;
     ret[9] = eNext.dram;
-    return List::create(Named("ret") = ret);
+    return List::create(Named("ret") = ret, Named("faults") = faults);
 }
 
-
 // [[Rcpp::export]]
-List ISkasort_exsitu(NumericVector & orig) {
+List ISkasort_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return ISkasort_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List ISkasort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   int i,n=orig.size();
   NumericVector ret(10);
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
+  GreensortRadixKey key(na_last, decreasing);
+  greensort_buffer<T> aux(false);
+  aux.resize(n);
   for (i=0;i<n;i++)
       aux[i] = orig[i];
-  inplace_radix_sort(aux.begin(), aux.end());
+  inplace_radix_sort(aux.begin(), aux.end(), key);
 
   for (i=0;i<n;i++)
       orig[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 2.0;
@@ -157,6 +191,11 @@ List ISkasort_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults);
+}
+
+// [[Rcpp::export]]
+List ISkasort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return ISkasort_exsitu(x, na_last, decreasing); });
 }
 
@@ -0,0 +1,132 @@
+/*
+# Code for marking sorted results with the sortedness metadata of R (ALTREP)
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ R skips work for vectors it knows to be sorted or free of NA: is.unsorted, sort, order, anyNA
+ and others ask an ALTREP vector through its Is_sorted and No_NA methods. Sorted_wrap wraps a
+ sorted double or integer vector into an ALTREP class of this package which answers both from
+ O(1) metadata: data1 is the vector, data2 holds c(sortedness, no_na). Elements are read from
+ data1 without copying, writing through the data pointer forgets the metadata. The classes do not
+ serialize themselves, saved results are restored as standard vectors. integer64 and logical
+ vectors are returned unchanged.
+*/
+
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+
+using namespace Rcpp;
+
+static R_altrep_class_t Sorted_real_class;
+static R_altrep_class_t Sorted_integer_class;
+
+static R_xlen_t Sorted_Length(SEXP x) {
+  return XLENGTH(R_altrep_data1(x));
+}
+
+static Rboolean Sorted_Inspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int)) {
+  int* m = INTEGER(R_altrep_data2(x));
+  Rprintf(" greensort sorted (sortedness %d, no_na %d)\n", m[0], m[1]);
+  inspect_subtree(R_altrep_data1(x), pre, deep, pvec);
+  return TRUE;
+}
+
+// A copy stays sorted (R copies the attributes)
+static SEXP Sorted_Duplicate(SEXP x, Rboolean deep) {
+  SEXP data = PROTECT(Rf_duplicate(R_altrep_data1(x)));
+  SEXP meta = PROTECT(Rf_duplicate(R_altrep_data2(x)));
+  SEXP ret = R_new_altrep(TYPEOF(data) == REALSXP ? Sorted_real_class : Sorted_integer_class, data, meta);
+  UNPROTECT(2);
+  return ret;
+}
+
+static void* Sorted_Dataptr(SEXP x, Rboolean writeable) {
+  SEXP data = R_altrep_data1(x);
+  if (writeable){
+    // the caller may change the data: forget that it is sorted
+    int* m = INTEGER(R_altrep_data2(x));
+    m[0] = UNKNOWN_SORTEDNESS;
+    m[1] = 0;
+    return TYPEOF(data) == REALSXP ? (void*) REAL(data) : (void*) INTEGER(data);
+  }
+  return TYPEOF(data) == REALSXP ? (void*) REAL_RO(data) : (void*) INTEGER_RO(data);
+}
+
+static const void* Sorted_Dataptr_or_null(SEXP x) {
+  SEXP data = R_altrep_data1(x);
+  return TYPEOF(data) == REALSXP ? (const void*) REAL_RO(data) : (const void*) INTEGER_RO(data);
+}
+
+static double Sorted_real_Elt(SEXP x, R_xlen_t i) {
+  return REAL_ELT(R_altrep_data1(x), i);
+}
+
+static int Sorted_integer_Elt(SEXP x, R_xlen_t i) {
+  return INTEGER_ELT(R_altrep_data1(x), i);
+}
+
+static R_xlen_t Sorted_real_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, double* buf) {
+  return REAL_GET_REGION(R_altrep_data1(x), i, n, buf);
+}
+
+static R_xlen_t Sorted_integer_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, int* buf) {
+  return INTEGER_GET_REGION(R_altrep_data1(x), i, n, buf);
+}
+
+static int Sorted_Is_sorted(SEXP x) {
+  return INTEGER(R_altrep_data2(x))[0];
+}
+
+static int Sorted_No_NA(SEXP x) {
+  return INTEGER(R_altrep_data2(x))[1];
+}
+
+// [[Rcpp::init]]
+void Sorted_init(DllInfo* dll) {
+  Sorted_real_class = R_make_altreal_class("greensort_sorted_real", "greeNsort.Rcpp", dll);
+  R_set_altrep_Length_method(Sorted_real_class, Sorted_Length);
+  R_set_altrep_Inspect_method(Sorted_real_class, Sorted_Inspect);
+  R_set_altrep_Duplicate_method(Sorted_real_class, Sorted_Duplicate);
+  R_set_altvec_Dataptr_method(Sorted_real_class, Sorted_Dataptr);
+  R_set_altvec_Dataptr_or_null_method(Sorted_real_class, Sorted_Dataptr_or_null);
+  R_set_altreal_Elt_method(Sorted_real_class, Sorted_real_Elt);
+  R_set_altreal_Get_region_method(Sorted_real_class, Sorted_real_Get_region);
+  R_set_altreal_Is_sorted_method(Sorted_real_class, Sorted_Is_sorted);
+  R_set_altreal_No_NA_method(Sorted_real_class, Sorted_No_NA);
+
+  Sorted_integer_class = R_make_altinteger_class("greensort_sorted_integer", "greeNsort.Rcpp", dll);
+  R_set_altrep_Length_method(Sorted_integer_class, Sorted_Length);
+  R_set_altrep_Inspect_method(Sorted_integer_class, Sorted_Inspect);
+  R_set_altrep_Duplicate_method(Sorted_integer_class, Sorted_Duplicate);
+  R_set_altvec_Dataptr_method(Sorted_integer_class, Sorted_Dataptr);
+  R_set_altvec_Dataptr_or_null_method(Sorted_integer_class, Sorted_Dataptr_or_null);
+  R_set_altinteger_Elt_method(Sorted_integer_class, Sorted_integer_Elt);
+  R_set_altinteger_Get_region_method(Sorted_integer_class, Sorted_integer_Get_region);
+  R_set_altinteger_Is_sorted_method(Sorted_integer_class, Sorted_Is_sorted);
+  R_set_altinteger_No_NA_method(Sorted_integer_class, Sorted_No_NA);
+}
+
+// Wraps x sorted by the engines (NA first or last) with its sortedness and whether it has NA
+// [[Rcpp::export]]
+SEXP Sorted_wrap(SEXP x, bool decreasing, bool na_last) {
+  bool real = TYPEOF(x) == REALSXP;
+  if ((!real && TYPEOF(x) != INTSXP) || Rf_inherits(x, "integer64"))
+    return x;
+  R_xlen_t n = XLENGTH(x);
+  // the engines put NA together at one end: looking there tells whether there is any
+  bool no_na = true;
+  if (n){
+    R_xlen_t i = na_last ? n - 1 : 0;
+    no_na = real ? !ISNAN(REAL_ELT(x, i)) : INTEGER_ELT(x, i) != NA_INTEGER;
+  }
+  SEXP meta = PROTECT(Rf_allocVector(INTSXP, 2));
+  INTEGER(meta)[0] = decreasing ? (na_last ? SORTED_DECR : SORTED_DECR_NA_1ST) : (na_last ? SORTED_INCR : SORTED_INCR_NA_1ST);
+  INTEGER(meta)[1] = no_na;
+  SEXP ret = PROTECT(R_new_altrep(real ? Sorted_real_class : Sorted_integer_class, x, meta));
+  SHALLOW_DUPLICATE_ATTRIB(ret, x);
+  UNPROTECT(2);
+  return ret;
+}
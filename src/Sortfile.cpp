@@ -0,0 +1,170 @@
+/*
+# Code for sorting binary files in place through a shared memory mapping
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ Sortfile sorts a binary file of doubles, integers or int64 (native byte order like writeBin)
+ without copying it into an R vector: the file is mapped with MAP_SHARED, the engine sorts the
+ mapped range in place and msync writes the dirty pages back. Only engines with bounded scratch
+ memory are offered (IS4o, IPS4o, ISkasort, Pdqsort, PdqsortB), hence the memory beyond the page
+ cache is independent of the file size (except for the NA set aside by GreensortNaSplit). The
+ mapping is advised MADV_WILLNEED (read ahead the whole file) and MADV_HUGEPAGE (honoured where the
+ file system supports huge page cache). It is not advised MADV_SEQUENTIAL: the partitioning of
+ pdqsort and IPS4o revisits pages, which the kernel would drop right after access.
+*/
+
+#include <Rcpp.h>
+#include "ips4o/ips4o.hpp"
+#include "pdq/pdqsort.h"
+#include "ska/ska_sort.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+enum Sortfile_engine {
+  SORTFILE_IS4O = 0
+, SORTFILE_IPS4O = 1
+, SORTFILE_ISKASORT = 2
+, SORTFILE_PDQSORT = 3
+, SORTFILE_PDQSORTB = 4
+};
+
+template<typename T, class C>
+static void Sortfile_sort(greensort_span<T> orig, int engine, int threads, bool na_last, bool decreasing, C comp) {
+  if (engine == SORTFILE_ISKASORT){
+    GreensortRadixKey key(na_last, decreasing);
+    ska::inplace_radix_sort<1, 1>(orig.begin(), orig.end(), key);
+    return;
+  }
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  switch (engine){
+  case SORTFILE_IS4O:
+    ips4o::sort(x.begin(), x.end(), comp);
+    break;
+  case SORTFILE_IPS4O:
+    ips4o::parallel::sort(x.begin(), x.end(), comp, threads);
+    break;
+  case SORTFILE_PDQSORT:
+    pdqsort(x.begin(), x.end(), comp);
+    break;
+  case SORTFILE_PDQSORTB:
+    pdqsort_branchless(x.begin(), x.end(), comp);
+    break;
+  default:
+    stop("unknown engine");
+  }
+}
+
+// A shared mapping of a whole file, unmapped also if the engine throws
+class Sortfile_map {
+public:
+  Sortfile_map(int fd, size_t bytes) : p_(nullptr), bytes_(bytes) {
+    if (!bytes)
+      return;
+    p_ = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p_ == MAP_FAILED)
+      p_ = nullptr;
+  }
+  Sortfile_map(const Sortfile_map&) = delete;
+  Sortfile_map& operator=(const Sortfile_map&) = delete;
+  ~Sortfile_map() {
+    if (p_)
+      munmap(p_, bytes_);
+  }
+  bool failed() const { return bytes_ && !p_; }
+  void* data() const { return p_; }
+  // writes the dirty pages back to the file, false (with errno) if that failed
+  bool sync() {
+    return !p_ || msync(p_, bytes_, MS_SYNC) == 0;
+  }
+private:
+  void* p_;
+  size_t bytes_;
+};
+
+template<typename T>
+List Sortfile_mmap(const std::string& path, int engine, int threads, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  NumericVector ret(10);
+  int fd = open(path.c_str(), O_RDWR);
+  if (fd < 0)
+    stop("cannot open '%s': %s", path, std::strerror(errno));
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size % sizeof(T)){
+    close(fd);
+    stop("the size of '%s' is not a multiple of the element size", path);
+  }
+  size_t bytes = st.st_size, n = bytes / sizeof(T);
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  Sortfile_map map(fd, bytes);
+  if (map.failed()){
+    int e = errno;
+    close(fd);
+    stop("cannot map '%s': %s", path, std::strerror(e));
+  }
+  close(fd);
+  if (bytes){
+    madvise(map.data(), bytes, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(map.data(), bytes, MADV_HUGEPAGE);
+#endif
+  }
+  greensort_span<T> x(static_cast<T*>(map.data()), n, REALSXP);
+  if (decreasing)
+    Sortfile_sort(x, engine, threads, na_last, decreasing, std::greater<>{});
+  else
+    Sortfile_sort(x, engine, threads, na_last, decreasing, std::less<>{});
+  auto synced = std::chrono::high_resolution_clock::now();
+  if (!map.sync()){
+    // the file may not be sorted on disk (EIO, ENOSPC on a sparse file, NFS)
+    int e = errno;
+    stop("cannot sync '%s': %s", path, std::strerror(e));
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = engine == SORTFILE_IPS4O ? threads : 1;
+  ret[3] = 1;
+  ret[4] = 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("sync") = std::chrono::duration <double, std::ratio<1,1>> (stop - synced).count());
+}
+
+// [[Rcpp::export]]
+List Sortfile_mmap(std::string path, std::string type, int engine, int threads, bool na_last, bool decreasing) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (type == "double")
+    return Sortfile_mmap<double>(path, engine, threads, na_last, decreasing);
+  if (type == "integer")
+    return Sortfile_mmap<int>(path, engine, threads, na_last, decreasing);
+  if (type == "integer64")
+    return Sortfile_mmap<std::int64_t>(path, engine, threads, na_last, decreasing);
+  stop("type must be double, integer or integer64");
+}
@@ -0,0 +1,412 @@
+/*
+# Code for sorting a stream of chunks incrementally (push chunks, pop sorted output)
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ A Streamsort object collects a stream of chunks whose total length is not known in advance.
+ Each pushed chunk is sorted immediately (its NA are set aside) and appended to one contiguous
+ store, where the sorted chunks form adjacent runs. A chunk continuing the last run (its first
+ value not before the last value of the run) just extends the run, presorted streams hence
+ collapse into one run. The runs are merged like in Powersort: the power of the boundary
+ between two runs is the number of leading bits their midpoints have in common, which does not
+ need the total length (it is the power of a virtual array of length 2^64 of which the stream is
+ a prefix). Before a run is pushed onto the stack, runs with a larger power are merged with the
+ run on the right, hence the stack keeps O(log n) runs and every element is moved O(log n) times
+ as the chunks arrive. A merge copies only the smaller of the two runs into a buffer.
+
+ Finishing does not merge the remaining stack: StreamsortNext pops the next k values from a
+ k-way merge of the stack runs (a heap of cursors, ties go to the earlier run, hence the
+ output is stable), such that the first values are available right after the last chunk. The
+ memory is the store (about n values) plus the merge buffer of at most the smaller run merged
+ and the NA set aside. The store is released when the last value was popped.
+*/
+
+#include <Rcpp.h>
+#include "ips4o/ips4o.hpp"
+#include "pdq/pdqsort.h"
+#include "ska/ska_sort.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
+
+using namespace Rcpp;
+
+enum Streamsort_engine {
+  STREAMSORT_PDQSORT = 0
+, STREAMSORT_PDQSORTB = 1
+, STREAMSORT_IS4O = 2
+, STREAMSORT_IPS4O = 3
+, STREAMSORT_ISKASORT = 4
+};
+
+// Power of the boundary between the runs [b1,e1) and [e1,e2): the common leading bits of their
+// (doubled) midpoints, larger powers are deeper in the merge tree
+static inline unsigned Streamsort_power(std::uint64_t b1, std::uint64_t e1, std::uint64_t e2) {
+  return __builtin_clzll((b1 + e1) ^ (e1 + e2));
+}
+
+// The typed part of a stream
+class Streamsort_base {
+public:
+  virtual ~Streamsort_base() {}
+  // sorts the chunk into the store and merges, returns the number of elements moved by merges
+  virtual double push(SEXP chunk) = 0;
+  // sets up the k-way merge of the remaining runs
+  virtual void finish() = 0;
+  // writes the next m values into the R vector value
+  virtual void next(SEXP value, R_xlen_t m) = 0;
+  virtual R_xlen_t size() const = 0;
+  virtual size_t runs() const = 0;
+  virtual double bytes() const = 0;
+};
+
+template<typename T>
+class Streamsort_typed : public Streamsort_base {
+public:
+  Streamsort_typed(int engine, int threads, bool na_last, bool decreasing)
+  : engine_(engine), threads_(threads), na_last_(na_last), decreasing_(decreasing)
+  , data_(false), buf_(false), end_(0), pending_(0), na_out_(0) {}
+
+  double push(SEXP chunk) {
+    if (decreasing_)
+      return push_(GreensortSpan<T>(chunk), std::greater<>{});
+    return push_(GreensortSpan<T>(chunk), std::less<>{});
+  }
+
+  void finish() {
+    if (end_ > pending_)
+      stack_.push_back(Streamsort_run{pending_, 0});
+    pending_ = end_;
+    if (decreasing_)
+      heapify_(std::greater<>{});
+    else
+      heapify_(std::less<>{});
+  }
+
+  void next(SEXP value, R_xlen_t m) {
+    next_(GreensortSpan<T>(value).begin(), m);
+  }
+
+  R_xlen_t size() const { return end_ + na_.size(); }
+  size_t runs() const { return stack_.size() + (end_ > pending_); }
+  double bytes() const { return (double) (data_.capacity() + buf_.capacity() + na_.capacity()) * sizeof(T); }
+
+private:
+  // a run on the stack and the power of its boundary with the run on its right
+  struct Streamsort_run {
+    size_t begin;
+    unsigned power;
+  };
+  // a cursor of the k-way merge
+  struct Streamsort_cursor {
+    size_t pos, end, run;
+  };
+
+  void next_(T* v, size_t m) {
+    size_t k = m, c = na_.size() - na_out_;
+    if (!na_last_ && c){
+      c = std::min(c, k);
+      std::copy(na_.begin() + na_out_, na_.begin() + na_out_ + c, v);
+      na_out_ += c; v += c; k -= c;
+    }
+    if (decreasing_)
+      v = pop_(v, k, std::greater<>{});
+    else
+      v = pop_(v, k, std::less<>{});
+    if (na_last_ && k){
+      std::copy(na_.begin() + na_out_, na_.begin() + na_out_ + k, v);
+      na_out_ += k;
+    }
+  }
+
+  template<class C>
+  double push_(greensort_span<T> x, C comp) {
+    size_t i, n = x.size(), b = end_, e;
+    double moved = 0;
+    if (data_.capacity() < end_ + n)
+      data_.reserve(std::max(end_ + n, data_.capacity() + data_.capacity() / 2));
+    data_.resize(data_.capacity());
+    // copy the values into the store, the NA aside
+    for (i=0,e=b;i<(size_t)n;i++){
+      T v = x[i];
+      if (GreensortIsNA(v))
+        na_.push_back(v);
+      else
+        data_[e++] = v;
+    }
+    if (e == b)
+      return moved;
+    sort_(data_.begin() + b, data_.begin() + e, comp);
+    end_ = e;
+    // a chunk continuing the pending run extends it
+    if (b == pending_ || !comp(data_[b], data_[b - 1]))
+      return moved;
+    unsigned p = Streamsort_power(pending_, b, e);
+    while (!stack_.empty() && stack_.back().power > p){
+      size_t a = stack_.back().begin;
+      stack_.pop_back();
+      moved += merge_(a, pending_, b, comp);
+      pending_ = a;
+    }
+    stack_.push_back(Streamsort_run{pending_, p});
+    pending_ = b;
+    return moved;
+  }
+
+  template<class C>
+  void sort_(T* l, T* r, C comp) {
+    switch (engine_){
+    case STREAMSORT_PDQSORT:
+      pdqsort(l, r, comp);
+      break;
+    case STREAMSORT_PDQSORTB:
+      pdqsort_branchless(l, r, comp);
+      break;
+    case STREAMSORT_IS4O:
+      ips4o::sort(l, r, comp);
+      break;
+    case STREAMSORT_IPS4O:
+      ips4o::parallel::sort(l, r, comp, threads_);
+      break;
+    case STREAMSORT_ISKASORT: {
+      GreensortRadixKey key(na_last_, decreasing_);
+      ska::inplace_radix_sort<1, 1>(l, r, key);
+      break;
+    }
+    default:
+      stop("unknown engine");
+    }
+  }
+
+  // Stable merge of the adjacent runs [a,m) and [m,b) through a buffer of the smaller run,
+  // returns the number of elements moved
+  template<class C>
+  double merge_(size_t a, size_t m, size_t b, C comp) {
+    T* x = data_.begin();
+    if (!comp(x[m], x[m - 1]))
+      return 0;
+    // elements already in place at both ends are not moved
+    a = std::upper_bound(x + a, x + m, x[m], comp) - x;
+    b = std::lower_bound(x + m, x + b, x[m - 1], comp) - x;
+    if (m - a <= b - m){
+      buf_.assign(x + a, x + m);
+      T *l = buf_.begin(), *le = buf_.end(), *r = x + m, *re = x + b, *o = x + a;
+      while (l < le && r < re)
+        *o++ = comp(*r, *l) ? *r++ : *l++;
+      std::copy(l, le, o);
+    }else{
+      buf_.assign(x + m, x + b);
+      T *l = x + m, *lb = x + a, *r = buf_.end(), *rb = buf_.begin(), *o = x + b;
+      while (l > lb && r > rb)
+        *--o = comp(r[-1], l[-1]) ? *--l : *--r;
+      std::copy_backward(rb, r, o);
+    }
+    return b - a;
+  }
+
+  template<class C>
+  struct Streamsort_later {
+    const T* x;
+    C comp;
+    // true if cursor u pops after cursor v
+    bool operator()(const Streamsort_cursor& u, const Streamsort_cursor& v) const {
+      if (comp(x[v.pos], x[u.pos]))
+        return true;
+      if (comp(x[u.pos], x[v.pos]))
+        return false;
+      return u.run > v.run;
+    }
+  };
+
+  template<class C>
+  void heapify_(C comp) {
+    size_t i;
+    heap_.clear();
+    for (i=0;i<stack_.size();i++){
+      size_t e = i + 1 < stack_.size() ? stack_[i + 1].begin : end_;
+      if (stack_[i].begin < e)
+        heap_.push_back(Streamsort_cursor{stack_[i].begin, e, i});
+    }
+    std::make_heap(heap_.begin(), heap_.end(), Streamsort_later<C>{data_.begin(), comp});
+  }
+
+  // pops up to k values of the runs into v, decrements k, returns the end of the values written
+  template<class C>
+  T* pop_(T* v, size_t& k, C comp) {
+    const T* x = data_.begin();
+    Streamsort_later<C> later{x, comp};
+    while (k && !heap_.empty()){
+      if (heap_.size() == 1){
+        // one run left: copy in one go
+        Streamsort_cursor& c = heap_.front();
+        size_t m = std::min(k, c.end - c.pos);
+        std::copy(x + c.pos, x + c.pos + m, v);
+        v += m; k -= m; c.pos += m;
+        if (c.pos == c.end)
+          heap_.clear();
+        break;
+      }
+      std::pop_heap(heap_.begin(), heap_.end(), later);
+      Streamsort_cursor& c = heap_.back();
+      *v++ = x[c.pos++];
+      k--;
+      if (c.pos == c.end)
+        heap_.pop_back();
+      else
+        std::push_heap(heap_.begin(), heap_.end(), later);
+    }
+    return v;
+  }
+
+  int engine_;
+  int threads_;
+  bool na_last_;
+  bool decreasing_;
+  greensort_buffer<T> data_;
+  greensort_buffer<T> buf_;
+  std::vector<T> na_;
+  std::vector<Streamsort_run> stack_;
+  std::vector<Streamsort_cursor> heap_;
+  size_t end_;      // end of the values in the store
+  size_t pending_;  // begin of the last run, which is not on the stack yet
+  size_t na_out_;   // number of NA popped
+};
+
+// A stream: the settings, the type of the first chunk and the typed part created for it
+class Streamsort_stream {
+public:
+  Streamsort_stream(int engine, int threads, bool na_last, bool decreasing)
+  : engine(engine), threads(threads), na_last(na_last), decreasing(decreasing)
+  , type(NILSXP), integer64(false), finished(false), popped(0) {}
+  int engine;
+  int threads;
+  bool na_last;
+  bool decreasing;
+  SEXPTYPE type;
+  bool integer64;
+  bool finished;
+  R_xlen_t popped;
+  RObject levels;
+  RObject cls;
+  std::unique_ptr<Streamsort_base> impl;
+};
+
+static Streamsort_stream * Streamsort_ptr(SEXP stream){
+  if (TYPEOF(stream) != EXTPTRSXP)
+    stop("stream must be an external pointer created by Streamsort_new");
+  Streamsort_stream *s = static_cast<Streamsort_stream*>(R_ExternalPtrAddr(stream));
+  if (s == NULL)
+    stop("stream pointer is NULL (restored from a saved session?)");
+  return s;
+}
+
+static NumericVector Streamsort_ret(R_xlen_t n, int b, int p, double size, double secs, GreensortEnergyT& eNext) {
+  NumericVector ret(10);
+  ret[0] = n;
+  ret[1] = b;
+  ret[2] = p;
+  ret[3] = 1;
+  ret[4] = size;
+  ret[5] = secs;
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return ret;
+}
+
+// [[Rcpp::export]]
+SEXP Streamsort_new(int engine, int threads, bool na_last, bool decreasing) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  XPtr<Streamsort_stream> stream(new Streamsort_stream(engine, threads, na_last, decreasing), true);
+  return stream;
+}
+
+// [[Rcpp::export]]
+List Streamsort_push(SEXP stream, SEXP chunk) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  Streamsort_stream *s = Streamsort_ptr(stream);
+  if (s->finished)
+    stop("the stream is finished");
+  bool integer64 = GreensortIsInteger64(chunk);
+  SEXPTYPE type = TYPEOF(chunk) == LGLSXP ? INTSXP : TYPEOF(chunk);
+  if (!s->impl){
+    if (type == REALSXP)
+      s->impl.reset(integer64 ? (Streamsort_base*) new Streamsort_typed<std::int64_t>(s->engine, s->threads, s->na_last, s->decreasing)
+                              : (Streamsort_base*) new Streamsort_typed<double>(s->engine, s->threads, s->na_last, s->decreasing));
+    else if (type == INTSXP)
+      s->impl.reset(new Streamsort_typed<int>(s->engine, s->threads, s->na_last, s->decreasing));
+    else
+      stop("only double, integer, logical, factor and integer64 vectors implemented");
+    s->type = TYPEOF(chunk);
+    s->integer64 = integer64;
+    s->levels = Rf_getAttrib(chunk, R_LevelsSymbol);
+    s->cls = Rf_getAttrib(chunk, R_ClassSymbol);
+  }else if (TYPEOF(chunk) != s->type || integer64 != s->integer64){
+    // the result is allocated with the type of the first chunk: logical and integer chunks must not be mixed
+    stop("the chunk has another type than the first chunk");
+  }else if (!R_compute_identical(Rf_getAttrib(chunk, R_ClassSymbol), s->cls, 16) || !R_compute_identical(Rf_getAttrib(chunk, R_LevelsSymbol), s->levels, 16)){
+    // the codes of a factor are only comparable with the same levels
+    stop("the chunk has another class or other levels than the first chunk");
+  }
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  double moved = s->impl->push(chunk);
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  R_xlen_t n = XLENGTH(chunk);
+  double total = s->impl->size();
+  NumericVector ret = Streamsort_ret(n, s->integer64 || s->type == REALSXP ? 8 : 4, s->engine == STREAMSORT_IPS4O ? s->threads : 1
+                                   , total ? s->impl->bytes() / (total * (s->integer64 || s->type == REALSXP ? 8 : 4)) : 0
+                                   , std::chrono::duration <double, std::ratio<1,1>> (stop - start).count(), eNext);
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("runs") = (double) s->impl->runs(), Named("moved") = moved);
+}
+
+// [[Rcpp::export]]
+double Streamsort_finish(SEXP stream) {
+  Streamsort_stream *s = Streamsort_ptr(stream);
+  if (s->finished)
+    stop("the stream is already finished");
+  s->finished = true;
+  if (!s->impl)
+    return 0;
+  s->impl->finish();
+  return s->impl->size();
+}
+
+// [[Rcpp::export]]
+SEXP Streamsort_next(SEXP stream, double k) {
+  Streamsort_stream *s = Streamsort_ptr(stream);
+  if (!s->finished)
+    stop("the stream must be finished before popping values");
+  // clamped as double before the cast, k may be Inf (all values)
+  double left = s->impl ? (double) (s->impl->size() - s->popped) : 0;
+  R_xlen_t m = k >= left ? (R_xlen_t) left : k > 0 ? (R_xlen_t) k : 0;
+  RObject value(Rf_allocVector(s->type == NILSXP ? LGLSXP : s->type, m));
+  if (m){
+    s->impl->next(value, m);
+    s->popped += m;
+    // all values are out: return the memory
+    if (s->popped == s->impl->size())
+      s->impl.reset();
+  }
+  if (!Rf_isNull(s->levels))
+    Rf_setAttrib(value, R_LevelsSymbol, s->levels);
+  if (!Rf_isNull(s->cls))
+    Rf_setAttrib(value, R_ClassSymbol, s->cls);
+  return value;
+}
@@ -0,0 +1,170 @@
+/*
+# Code for interfacing and timing Strsort
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+*/
+
+/*
+ Sorting of character vectors in C collation (byte order, locale-free) without copying strings:
+ the engine sorts CHARSXP pointers with the multikey quicksort of str/strsort.h. R keeps every
+ string once in its global CHARSXP cache, hence equal strings are the same pointer. With
+ cache=TRUE the distinct CHARSXPs are counted in a pointer hash table, only they are sorted,
+ and each is written back as often as it occurred. NA is put last.
+*/
+
+#include <Rcpp.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include "str/strsort.h"
+#include "lib_energy.h"
+#include "buffer_cache.h"
+
+using namespace Rcpp;
+
+// A string to be sorted with its payload (the CHARSXP or the index of the distinct string)
+template<class P>
+struct Strsort_elem {
+  const unsigned char* s;
+  P x;
+};
+
+template<class P>
+static inline const unsigned char* Strsort_str(const Strsort_elem<P>& e){
+  return e.s;
+}
+
+// Open addressing hash table from CHARSXP pointer to the index of the distinct string
+struct Strsort_slot {
+  SEXP key;
+  size_t id;
+};
+
+static inline size_t Strsort_hash(SEXP s, int bits){
+  return (size_t) ((((std::uintptr_t) s) >> 3) * UINT64_C(0x9E3779B97F4A7C15) >> (64 - bits));
+}
+
+static inline void Strsort_insert(greensort_buffer<Strsort_slot>& table, int bits, SEXP s, size_t id){
+  size_t h = Strsort_hash(s, bits);
+  while (table[h].key)
+    h = (h + 1) & (table.size() - 1);
+  table[h] = Strsort_slot{s, id};
+}
+
+// Sorts the n non-NA CHARSXPs in[0..n) to out[0..n), returns the number of distinct strings
+static size_t Strsort_cache(const SEXP* in, size_t n, SEXP* out){
+  size_t i, j, k, h, u = 0;
+  int bits = 10;
+  greensort_buffer<Strsort_slot> table;
+  table.resize((size_t) 1 << bits);
+  std::memset(table.data(), 0, table.size() * sizeof(Strsort_slot));
+  greensort_buffer<SEXP> charsxp;
+  greensort_buffer<size_t> count;
+  for (i=0;i<n;i++){
+    SEXP s = in[i];
+    h = Strsort_hash(s, bits);
+    while (table[h].key && table[h].key != s)
+      h = (h + 1) & (table.size() - 1);
+    if (table[h].key){
+      count[table[h].id]++;
+      continue;
+    }
+    table[h] = Strsort_slot{s, u};
+    if (u == charsxp.capacity()){
+      charsxp.reserve(2 * u + 256);
+      count.reserve(2 * u + 256);
+    }
+    charsxp.resize(u + 1);
+    count.resize(u + 1);
+    charsxp[u] = s;
+    count[u] = 1;
+    u++;
+    // keep the load factor below 1/2
+    if (2 * u > table.size()){
+      bits++;
+      table.resize((size_t) 1 << bits);
+      std::memset(table.data(), 0, table.size() * sizeof(Strsort_slot));
+      for (j=0;j<u;j++)
+        Strsort_insert(table, bits, charsxp[j], j);
+    }
+  }
+  // sort the distinct strings and write each as often as it occurred
+  greensort_buffer<Strsort_elem<size_t>> uniq;
+  uniq.resize(u);
+  for (j=0;j<u;j++)
+    uniq[j] = Strsort_elem<size_t>{(const unsigned char*) CHAR(charsxp[j]), j};
+  strsort::mkqsort(uniq.data(), u, Strsort_str<size_t>);
+  for (k=0,j=0;j<u;j++){
+    size_t d = uniq[j].x;
+    SEXP s = charsxp[d];
+    for (i=count[d];i>0;i--)
+      out[k++] = s;
+  }
+  return u;
+}
+
+// Sorts the n non-NA CHARSXPs in[0..n) to out[0..n) with multikey quicksort on all elements
+static void Strsort_all(const SEXP* in, size_t n, SEXP* out){
+  size_t i;
+  greensort_buffer<Strsort_elem<SEXP>> a;
+  a.resize(n);
+  for (i=0;i<n;i++)
+    a[i] = Strsort_elem<SEXP>{(const unsigned char*) CHAR(in[i]), in[i]};
+  strsort::mkqsort(a.data(), n, Strsort_str<SEXP>);
+  for (i=0;i<n;i++)
+    out[i] = a[i].x;
+}
+
+
+// [[Rcpp::export]]
+List Strsort_insitu(SEXP orig, bool cache) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  if (TYPEOF(orig) != STRSXP)
+    stop("only character vectors implemented");
+  R_xlen_t i, m, n = XLENGTH(orig);
+  NumericVector ret(10);
+  size_t u = 0;
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  const SEXP* x = STRING_PTR_RO(orig);
+  greensort_buffer<SEXP> in;
+  in.resize(n);
+  m = 0;
+  for (i=0;i<n;i++)
+    if (x[i] != NA_STRING)
+      in[m++] = x[i];
+  greensort_buffer<SEXP> out;
+  out.resize(n);
+  if (cache)
+    u = Strsort_cache(in.data(), m, out.data());
+  else
+    Strsort_all(in.data(), m, out.data());
+  for (i=0;i<m;i++)
+    SET_STRING_ELT(orig, i, out[i]);
+  for (i=m;i<n;i++)
+    SET_STRING_ELT(orig, i, NA_STRING);
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(SEXP);
+  ret[2] = 1;
+  ret[3] = 1;
+  // the pointers, their non-NA copy and the sorted copy plus for the cache per distinct string a
+  // sort element, up to 4 hash slots (load 1/4 to 1/2), its count and its CHARSXP
+  if (cache)
+    ret[4] = n ? 3.0 + u * (sizeof(Strsort_elem<size_t>) + 4 * sizeof(Strsort_slot) + 2 * sizeof(size_t)) / (double) (n * sizeof(SEXP)) : 1.0;
+  else
+    ret[4] = 3.0 + (double) sizeof(Strsort_elem<SEXP>) / sizeof(SEXP);
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("unique") = (double) u, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
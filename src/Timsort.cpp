@@ -7,28 +7,41 @@
 
 #include <Rcpp.h>
 #include "tim/timsort.h"
+#include "tim/timsort_parallel.h"
+#include "tim/timsort_preallocated.h"
 #include <chrono>
+#include <thread>
 
 #include "lib_energy.h"
+#include "buffer_cache.h"
+#include "sort_types.h"
+#include "sort_na.h"
 
 using namespace Rcpp;
 
 
-// [[Rcpp::export]]
-List Timsort_insitu(NumericVector & orig) {
+template<typename T>
+List Timsort_insitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int n=orig.size();
   NumericVector ret(10);
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  tim::timsort(orig.begin(), orig.end(), std::less<>{});
-  //STABLE_TEST_PSEUDO_ROUND - IS STABLE:  tim::timsort(orig.begin(), orig.end(), [](auto x, auto y){ return floor(x) < floor(y); });
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    tim::timsort(x.begin(), x.end(), std::greater<>{});
+  else
+    tim::timsort(x.begin(), x.end(), std::less<>{});
+  //STABLE_TEST_PSEUDO_ROUND - IS STABLE:  tim::timsort(x.begin(), x.end(), [](auto x, auto y){ return floor(x) < floor(y); });
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.5;
@@ -37,29 +50,42 @@ List Timsort_insitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
 }
 
-
 // [[Rcpp::export]]
-List Timsort_exsitu(NumericVector & orig) {
+List Timsort_insitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Timsort_insitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List Timsort_exsitu(greensort_span<T> orig, bool na_last, bool decreasing) {
   PCapEnergyT eLast;
   GreensortEnergyT eNext;
   int i,n=orig.size();
   NumericVector ret(10);
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
   eLast = GreensortEnergyNow();
   auto start = std::chrono::high_resolution_clock::now();
-  NumericVector aux(n);
-  for (i=0;i<n;i++)
-      aux[i] = orig[i];
-  tim::timsort(aux.begin(), aux.end(), std::less<>{});
-  for (i=0;i<n;i++)
-      orig[i] = aux[i];
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (decreasing)
+    tim::timsort(aux.begin(), aux.end(), std::greater<>{});
+  else
+    tim::timsort(aux.begin(), aux.end(), std::less<>{});
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
   auto stop = std::chrono::high_resolution_clock::now();
   eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
   auto diff = stop - start;
   ret[0] = n;
-  ret[1] = 8;
+  ret[1] = sizeof(T);
   ret[2] = 1;
   ret[3] = 1;
   ret[4] = 1.5;
@@ -68,5 +94,214 @@ List Timsort_exsitu(NumericVector & orig) {
   ret[7] = eNext.core;
   ret[8] = eNext.unco;
   ret[9] = eNext.dram;
-  return List::create(Named("ret") = ret);
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
+
+// [[Rcpp::export]]
+List Timsort_exsitu(SEXP orig, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return Timsort_exsitu(x, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PTimsort_insitu(greensort_span<T> orig, int threads, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int n=orig.size();
+  NumericVector ret(10);
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (decreasing)
+    tim::timsort_parallel(x.begin(), x.end(), std::greater<>{}, threads);
+  else
+    tim::timsort_parallel(x.begin(), x.end(), std::less<>{}, threads);
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = threads;
+  ret[3] = 1;
+  ret[4] = 2.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
+
+// [[Rcpp::export]]
+List PTimsort_insitu(SEXP orig, int threads, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PTimsort_insitu(x, threads, na_last, decreasing); });
+}
+
+
+template<typename T>
+List PTimsort_exsitu(greensort_span<T> orig, int threads, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int i,n=orig.size();
+  NumericVector ret(10);
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (decreasing)
+    tim::timsort_parallel(aux.begin(), aux.end(), std::greater<>{}, threads);
+  else
+    tim::timsort_parallel(aux.begin(), aux.end(), std::less<>{}, threads);
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = threads;
+  ret[3] = 1;
+  ret[4] = 2.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0);
+}
+
+// [[Rcpp::export]]
+List PTimsort_exsitu(SEXP orig, int threads, bool na_last, bool decreasing) {
+  return GreensortDispatch(orig, [&](auto x){ return PTimsort_exsitu(x, threads, na_last, decreasing); });
+}
+
+
+// timsort_preallocated overwrites the scratch buffer while merging: it must not share memory with x
+static void TimsortPre_check_scratch(SEXP orig, Nullable<NumericVector> scratch) {
+  if (scratch.isNull())
+    return;
+  SEXP s = scratch.get();
+  R_xlen_t n = Rf_xlength(orig), m = Rf_xlength(s);
+  if (!n || !m)
+    return;
+  const char* xb = TYPEOF(orig) == REALSXP ? (const char*) REAL(orig) : (const char*) INTEGER(orig);
+  const char* xe = xb + n * (TYPEOF(orig) == REALSXP ? sizeof(double) : sizeof(int));
+  const char* sb = (const char*) REAL(s);
+  const char* se = sb + m * sizeof(double);
+  if (sb < xe && xb < se)
+    stop("scratch must not share memory with x");
+}
+
+template<typename T>
+List TimsortPre_insitu(greensort_span<T> orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int n=orig.size();
+  NumericVector ret(10);
+  size_t maxbuf;
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  if (scratch.isNotNull()){
+    NumericVector s(scratch);
+    if (decreasing)
+      maxbuf = tim::timsort_preallocated(x.begin(), x.end(), std::greater<>{}, reinterpret_cast<T*>(s.begin()), s.size() * sizeof(double) / sizeof(T));
+    else
+      maxbuf = tim::timsort_preallocated(x.begin(), x.end(), std::less<>{}, reinterpret_cast<T*>(s.begin()), s.size() * sizeof(double) / sizeof(T));
+  }else{
+    if (decreasing)
+      maxbuf = tim::timsort_preallocated(x.begin(), x.end(), std::greater<>{});
+    else
+      maxbuf = tim::timsort_preallocated(x.begin(), x.end(), std::less<>{});
+  }
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = n ? 1.0 + (double) maxbuf / n : 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0, Named("maxbuf") = (double) maxbuf);
+}
+
+// [[Rcpp::export]]
+List TimsortPre_insitu(SEXP orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing) {
+  TimsortPre_check_scratch(orig, scratch);
+  return GreensortDispatch(orig, [&](auto x){ return TimsortPre_insitu(x, scratch, na_last, decreasing); });
+}
+
+
+template<typename T>
+List TimsortPre_exsitu(greensort_span<T> orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing) {
+  PCapEnergyT eLast;
+  GreensortEnergyT eNext;
+  int i,n=orig.size();
+  NumericVector ret(10);
+  size_t maxbuf;
+  double alloc0 = GreensortBufferAllocSecs();
+  double faults0 = GreensortPageFaults();
+  eLast = GreensortEnergyNow();
+  auto start = std::chrono::high_resolution_clock::now();
+  greensort_span<T> x = GreensortNaSplit(orig, na_last);
+  greensort_buffer<T> aux(false);
+  aux.resize(x.size());
+  for (i=0;i<x.size();i++)
+      aux[i] = x[i];
+  if (scratch.isNotNull()){
+    NumericVector s(scratch);
+    if (decreasing)
+      maxbuf = tim::timsort_preallocated(aux.begin(), aux.end(), std::greater<>{}, reinterpret_cast<T*>(s.begin()), s.size() * sizeof(double) / sizeof(T));
+    else
+      maxbuf = tim::timsort_preallocated(aux.begin(), aux.end(), std::less<>{}, reinterpret_cast<T*>(s.begin()), s.size() * sizeof(double) / sizeof(T));
+  }else{
+    if (decreasing)
+      maxbuf = tim::timsort_preallocated(aux.begin(), aux.end(), std::greater<>{});
+    else
+      maxbuf = tim::timsort_preallocated(aux.begin(), aux.end(), std::less<>{});
+  }
+  for (i=0;i<x.size();i++)
+      x[i] = aux[i];
+  auto stop = std::chrono::high_resolution_clock::now();
+  eNext = GreensortEnergyDelta(&eLast);
+  double faults = GreensortPageFaults() - faults0;
+  auto diff = stop - start;
+  ret[0] = n;
+  ret[1] = sizeof(T);
+  ret[2] = 1;
+  ret[3] = 1;
+  ret[4] = n ? 1.0 + (double) maxbuf / n : 1.0;
+  ret[5] = std::chrono::duration <double, std::ratio<1,1>> (diff).count();
+  ret[6] = eNext.base;
+  ret[7] = eNext.core;
+  ret[8] = eNext.unco;
+  ret[9] = eNext.dram;
+  return List::create(Named("ret") = ret, Named("faults") = faults, Named("alloc") = GreensortBufferAllocSecs() - alloc0, Named("maxbuf") = (double) maxbuf);
+}
+
+// [[Rcpp::export]]
+List TimsortPre_exsitu(SEXP orig, Nullable<NumericVector> scratch, bool na_last, bool decreasing) {
+  TimsortPre_check_scratch(orig, scratch);
+  return GreensortDispatch(orig, [&](auto x){ return TimsortPre_exsitu(x, scratch, na_last, decreasing); });
 }
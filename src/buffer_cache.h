@@ -0,0 +1,134 @@
+/*
+# greeNsort Header-Code for the cross-call cache of sort buffers
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+#*/
+
+/*
+ The buffered sorters (Peeksort, Powersort, Powersort4, gfx::timsort, tim::timsort) draw their
+ merge buffers from one package-wide cache instead of allocating (and page-faulting) fresh
+ memory on every call. Buffers are handed out in size classes (four per power of two, at least
+ 4 KiB), returned buffers are kept up to a limit of cached bytes. Buffers of 2 MiB and more are
+ mapped with mmap according to the allocation policy (transparent huge pages, pre-faulting or
+ explicit hugetlbfs pages). The exsitu wrappers take their fresh data and buffer copies directly
+ from the allocator (same policy, bypassing the cache).
+ The cache is controlled from R with BufferCacheWarm, BufferCacheLimit, BufferCacheRelease,
+ BufferCacheInfo and BufferPolicy (see BufferCache.cpp).
+*/
+
+#ifndef ALREADY_DEFINED_buffer_cache_h
+#define ALREADY_DEFINED_buffer_cache_h
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+// Returns a buffer of at least bytes bytes, its capacity (size class) is written to *capacity
+void* GreensortBufferAcquire(size_t bytes, size_t* capacity);
+
+// Returns the buffer to the cache (or frees it if the cache is full)
+void GreensortBufferRelease(void* p, size_t capacity);
+
+// Cumulated seconds spent in allocating buffers (cache misses) since loading the package
+double GreensortBufferAllocSecs();
+
+// Allocation policies for buffers of 2 MiB and more
+enum greensort_alloc_policy {
+  GREENSORT_ALLOC_DEFAULT = 0   // plain mmap, pages are faulted in on first touch
+, GREENSORT_ALLOC_HUGEPAGE = 1  // madvise(MADV_HUGEPAGE), transparent huge pages
+, GREENSORT_ALLOC_POPULATE = 2  // mmap(MAP_POPULATE), all pages faulted in at allocation
+, GREENSORT_ALLOC_HUGETLB = 3   // mmap(MAP_HUGETLB) from hugetlbfs, falls back to DEFAULT
+};
+
+// Allocates a fresh buffer of at least bytes bytes according to the policy (bypassing the cache)
+void* GreensortBufferAllocate(size_t bytes, size_t* capacity);
+
+// Frees a buffer from GreensortBufferAllocate
+void GreensortBufferFree(void* p, size_t capacity);
+
+// Number of page faults (minor and major) of the process so far, NA where not available
+double GreensortPageFaults();
+
+
+// A minimal std::vector replacement for trivially copyable elements drawing its memory from
+// the buffer cache (or, if not cached, freshly from the allocator). resize() does not initialize
+// new elements, which saves the zeroing of the buffer.
+template<class T>
+class greensort_buffer {
+  static_assert(std::is_trivially_copyable<T>::value, "greensort_buffer needs trivially copyable elements");
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::reverse_iterator<T*> reverse_iterator;
+
+  explicit greensort_buffer(bool cached = true)
+  : data_(nullptr), size_(0), capacity_(0), bytes_(0), cached_(cached) {}
+  greensort_buffer(const greensort_buffer&) = delete;
+  greensort_buffer& operator=(const greensort_buffer&) = delete;
+  ~greensort_buffer() {
+    if (data_)
+      free_(data_, bytes_);
+  }
+
+  void reserve(size_t n) {
+    if (n <= capacity_)
+      return;
+    size_t bytes;
+    T* p = static_cast<T*>(cached_ ? GreensortBufferAcquire(n * sizeof(T), &bytes)
+                                   : GreensortBufferAllocate(n * sizeof(T), &bytes));
+    if (data_) {
+      if (size_)
+        std::memcpy(p, data_, size_ * sizeof(T));
+      free_(data_, bytes_);
+    }
+    data_ = p;
+    bytes_ = bytes;
+    capacity_ = bytes / sizeof(T);
+  }
+  void resize(size_t n) {
+    reserve(n);
+    size_ = n;
+  }
+  void clear() { size_ = 0; }
+  template<class It>
+  void assign(It first, It last) {
+    size_t n = std::distance(first, last);
+    clear();
+    reserve(n);
+    std::copy(first, last, data_);
+    size_ = n;
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  T& operator[](size_t i) { return data_[i]; }
+  const T& operator[](size_t i) const { return data_[i]; }
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+
+private:
+  void free_(void* p, size_t bytes) {
+    if (cached_)
+      GreensortBufferRelease(p, bytes);
+    else
+      GreensortBufferFree(p, bytes);
+  }
+  T* data_;
+  size_t size_;
+  size_t capacity_;
+  size_t bytes_;
+  bool cached_;
+};
+
+#endif
@@ -30,8 +30,11 @@
 #include <cmath>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
+#include "rmi_predict.h"
 //#include "../pdq/pdqsort.h"
 
 using std::iterator_traits;
@@ -89,6 +92,10 @@ public:
     Params(float sampling_rate, float overallocation, unsigned int fanout,
            unsigned int batch_size, unsigned int threshold,
            vector<unsigned int> model_arch);
+
+    // Default hyperparameters with fanout and sampling rate chosen from the
+    // input size
+    static Params autotuned(size_t input_sz);
   };
 
   // Member variables of the CDF model
@@ -101,6 +108,15 @@ public:
   explicit RMI(Params p);
 };
 
+// Counts of keys that were not placed by the model in one sorting pass
+struct sort_stats {
+  // Number of keys that overflowed their bucket and went to the spill bucket
+  size_t n_spill = 0;
+
+  // Number of keys that were handled as repeated keys (exceptions)
+  size_t n_exceptions = 0;
+};
+
 // Training function
 template <class RandomIt>
 RMI<typename iterator_traits<RandomIt>::value_type> train(
@@ -114,9 +130,21 @@ void sort(RandomIt, RandomIt);
 
 // Default comparison function [std::less()] and custom hyperparameters
 template <class RandomIt>
-void sort(
+sort_stats sort(
     RandomIt, RandomIt,
     typename RMI<typename iterator_traits<RandomIt>::value_type>::Params &);
+
+// Default comparison function [std::less()] and a previously trained model
+template <class RandomIt>
+sort_stats sort(RandomIt, RandomIt,
+                RMI<typename iterator_traits<RandomIt>::value_type> &);
+
+// Flattens a model into a vector of doubles and restores it from one
+template <class T>
+vector<double> serialize(const RMI<T> &);
+
+template <class T>
+RMI<T> deserialize(const double *, size_t);
 }  // namespace learned_sort
 
 using namespace learned_sort;
@@ -143,6 +171,37 @@ RMI<T>::Params::Params(float sampling_rate, float overallocation,
   this->arch = std::move(arch);
 }
 
+/**
+ * @brief Chooses the fanout and the sampling rate from the input size, the
+ * remaining hyperparameters keep their defaults.
+ *
+ * The fanout grows with the square root of the input size (giving the
+ * default of 1000 at 1e8 keys), such that the major buckets grow as well but
+ * stay a multiple of the minor bucket threshold. The sampling rate is chosen
+ * such that the leaf layer sees about 100 training points per model, which
+ * is the default rate of 1% at 1e7 keys.
+ *
+ * @param input_sz The number of keys to be sorted
+ * @return learned_sort::RMI::Params The hyperparameters for this input size
+ */
+template <class T>
+typename RMI<T>::Params RMI<T>::Params::autotuned(size_t input_sz) {
+  Params p;
+  const double n = std::max<double>(1, input_sz);
+
+  // Fanout
+  p.fanout = static_cast<unsigned int>(
+      std::max(10., std::min(1e4, std::round(std::sqrt(n) / 10))));
+  p.fanout = std::max(
+      1u, std::min(p.fanout, static_cast<unsigned int>(n / (2. * p.threshold))));
+
+  // Sampling rate
+  p.sampling_rate = static_cast<float>(
+      std::max(1e-4, std::min(.1, 100. * p.arch[1] / n)));
+
+  return p;
+}
+
 template <class T>
 RMI<T>::RMI(Params p) {
   this->trained = false;
@@ -155,43 +214,30 @@ RMI<T>::RMI(Params p) {
 }
 
 /**
- * @brief Train a CDF function with an RMI architecture, using linear spline
- * interpolation.
- *
- * @tparam RandomIt A bi-directional random iterator over the dataset
- * @tparam Compare  A comparison function to learn. If std::less, the predicted
- * order of keys will be the normal sorted order. Otherwise, if std::greater is
- * passed, the keys will be predicted in reverse sorting order.
- * @param begin Random-access iterators to the initial position of the sequence
- * to be used for sorting. The range used is [begin,end), which contains all the
- * elements between first and last, including the element pointed by first but
- * not the element pointed by last.
- * @param end Random-access iterators to the last position of the sequence to be
- * used for sorting. The range used is [begin,end), which contains all the
- * elements between first and last, including the element pointed by first but
- * not the element pointed by last.
- * @param comp Binary function that accepts two elements in the range as
- * arguments, and returns a value convertible to bool. The value returned
- * indicates whether the element passed as first argument is considered to go
- * before the second in the specific strict weak ordering it defines. The
- * function shall not modify any of its arguments. This can either be a function
- * pointer or a function object.
- * @param p The hyperparameters for the CDF model, which describe the
- * architecture and sampling ratio.
- * @return learned_sort::RMI The trained model which, given a key, will output a
- * value between [0,1] as a predicted CDF value.
+ * @brief A leaf model whose training keys are all equal (heavy duplicates)
+ * would get an infinite or NaN slope, which sends its keys to the last bucket
+ * and breaks the order of the repeated keys. Such a model predicts the
+ * constant CDF of its first training point instead.
  */
-template <class RandomIt>
-RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
-    RandomIt begin, RandomIt end,
-    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params &p) {
-  // Determine the data type
-  typedef typename iterator_traits<RandomIt>::value_type T;
-
-  // Determine input size
-  const unsigned int INPUT_SZ = std::distance(begin, end);
+template <class T>
+void _flatten_degenerate_model(typename RMI<T>::linear_model *model,
+                               const training_point<T> &min,
+                               const training_point<T> &max) {
+  if (!(max.x > min.x)) {
+    model->slope = 0;
+    model->intercept = min.y;
+  }
+}
 
-  // Validate parameters
+/**
+ * @brief Replaces invalid hyperparameters by their defaults (with a warning).
+ *
+ * @tparam T The key type
+ * @param p The hyperparameters, modified in place
+ * @param INPUT_SZ The number of keys to be sorted
+ */
+template <class T>
+void _validate_params(typename RMI<T>::Params &p, const unsigned int INPUT_SZ) {
   if (p.batch_sz >= INPUT_SZ) {
     p.batch_sz = RMI<T>::Params::DEFAULT_BATCH_SZ;
     cerr << "\33[93;1mWARNING\33[0m: Invalid batch size. Using default ("
@@ -229,10 +275,51 @@ RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
     cerr << "\33[93;1mWARNING\33[0m: Invalid architecture. Using default {"
          << p.DEFAULT_ARCH[0] << ", " << p.DEFAULT_ARCH[1] << "}." << endl;
   }
+}
+
+/**
+ * @brief Train a CDF function with an RMI architecture, using linear spline
+ * interpolation.
+ *
+ * @tparam RandomIt A bi-directional random iterator over the dataset
+ * @tparam Compare  A comparison function to learn. If std::less, the predicted
+ * order of keys will be the normal sorted order. Otherwise, if std::greater is
+ * passed, the keys will be predicted in reverse sorting order.
+ * @param begin Random-access iterators to the initial position of the sequence
+ * to be used for sorting. The range used is [begin,end), which contains all the
+ * elements between first and last, including the element pointed by first but
+ * not the element pointed by last.
+ * @param end Random-access iterators to the last position of the sequence to be
+ * used for sorting. The range used is [begin,end), which contains all the
+ * elements between first and last, including the element pointed by first but
+ * not the element pointed by last.
+ * @param comp Binary function that accepts two elements in the range as
+ * arguments, and returns a value convertible to bool. The value returned
+ * indicates whether the element passed as first argument is considered to go
+ * before the second in the specific strict weak ordering it defines. The
+ * function shall not modify any of its arguments. This can either be a function
+ * pointer or a function object.
+ * @param p The hyperparameters for the CDF model, which describe the
+ * architecture and sampling ratio.
+ * @return learned_sort::RMI The trained model which, given a key, will output a
+ * value between [0,1] as a predicted CDF value.
+ */
+template <class RandomIt>
+RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
+    RandomIt begin, RandomIt end,
+    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params &p) {
+  // Determine the data type
+  typedef typename iterator_traits<RandomIt>::value_type T;
+
+  // Determine input size
+  const unsigned int INPUT_SZ = std::distance(begin, end);
+
+  // Validate parameters
+  _validate_params<T>(p, INPUT_SZ);
 
   // Initialize the CDF model
   RMI<T> rmi(p);
-  static const unsigned int NUM_LAYERS = p.arch.size();
+  const unsigned int NUM_LAYERS = p.arch.size();
   vector<vector<vector<training_point<T>>>> training_data(NUM_LAYERS);
   for (unsigned int layer_idx = 0; layer_idx < NUM_LAYERS; ++layer_idx) {
     training_data[layer_idx].resize(p.arch[layer_idx]);
@@ -333,6 +420,7 @@ RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
         // Hallucinating as if min.y = 0
         current_model->slope = (1. * max.y) / (max.x - min.x);
         current_model->intercept = min.y - current_model->slope * min.x;
+        _flatten_degenerate_model(current_model, min, max);
       }
     } else if (model_idx == p.arch[1] - 1) {
       if (current_training_data
@@ -348,6 +436,7 @@ RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
         // Hallucinating as if max.y = 1
         current_model->slope = (1. - min.y) / (max.x - min.x);
         current_model->intercept = min.y - current_model->slope * min.x;
+        _flatten_degenerate_model(current_model, min, max);
       }
     } else {  // The current model is not the first model in the current layer
 
@@ -376,6 +465,7 @@ RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
 
         current_model->slope = (max.y - min.y) / (max.x - min.x);
         current_model->intercept = min.y - current_model->slope * min.x;
+        _flatten_degenerate_model(current_model, min, max);
       }
     }
   }
@@ -397,16 +487,18 @@ RMI<typename iterator_traits<RandomIt>::value_type> learned_sort::train(
 }  // end of training function
 
 template <class RandomIt>
-void _sort_trained(RandomIt begin, RandomIt end,
-                   RMI<typename iterator_traits<RandomIt>::value_type> &rmi) {
+sort_stats _sort_trained(
+    RandomIt begin, RandomIt end,
+    RMI<typename iterator_traits<RandomIt>::value_type> &rmi) {
   // Determine the data type
   typedef typename iterator_traits<RandomIt>::value_type T;
 
-  // Cache runtime parameters
-  static const unsigned int BATCH_SZ = rmi.hp.batch_sz;
-  static const double OA_RATIO = rmi.hp.overallocation_ratio;
-  static const unsigned int FANOUT = rmi.hp.fanout;
-  static const unsigned int THRESHOLD = rmi.hp.threshold;
+  // Cache runtime parameters (NOTE: these must not be static, the
+  // hyperparameters may differ between calls)
+  const unsigned int BATCH_SZ = rmi.hp.batch_sz;
+  const double OA_RATIO = rmi.hp.overallocation_ratio;
+  const unsigned int FANOUT = rmi.hp.fanout;
+  const unsigned int THRESHOLD = rmi.hp.threshold;
 
   // Determine the input size
   const unsigned int INPUT_SZ = std::distance(begin, end);
@@ -438,7 +530,7 @@ void _sort_trained(RandomIt begin, RandomIt end,
       EXCEPTION_VEC_INIT_CAPACITY);  // Stores the predicted ranks of each
   // repeated
   // key
-  vector<vector<T>> repeated_key_counts(
+  vector<vector<unsigned int>> repeated_key_counts(
       EXCEPTION_VEC_INIT_CAPACITY);  // Stores the count of repeated keys
   unsigned int total_repeated_keys = 0;
 
@@ -456,6 +548,10 @@ void _sort_trained(RandomIt begin, RandomIt end,
     intercepts.push_back(rmi.models[1][i].intercept);
   }
 
+  // Batched (vectorized) model inference
+  const rmi_predictor<T> predict(root_slope, root_intrcpt, num_models,
+                                 slopes.data(), intercepts.data());
+
   //----------------------------------------------------------//
   //       DETECT REPEATED KEYS IN THE TRAINING SAMPLE        //
   //----------------------------------------------------------//
@@ -485,49 +581,49 @@ void _sort_trained(RandomIt begin, RandomIt end,
   // For each spike value, predict the bucket.
   // In repeated_keys_predicted_ranks[predicted_bucket_idx] save the value, in
   // repeated_keys_predicted_ranks[predicted_bucket_idx] save the counts
-  int pred_model_idx = 0;
-  double pred_cdf = 0.;
+  // NOTE: the repeated keys must be predicted with the same kernel as the
+  // input keys, such that they are found in the exception lists
+  vector<unsigned int> repeated_keys_pred_idx(repeated_keys.size());
+  predict(repeated_keys.data(), repeated_keys.size(), FANOUT, 0., FANOUT - 1.,
+          repeated_keys_pred_idx.data());
   for (size_t i = 0; i < repeated_keys.size(); ++i) {
-    pred_model_idx = static_cast<int>(
-      std::max(0., std::min(num_models - 1.,
-                            root_slope * repeated_keys[i] + root_intrcpt)));
-    pred_cdf =
-      slopes[pred_model_idx] * repeated_keys[i] + intercepts[pred_model_idx];
-    pred_model_idx = static_cast<int>(
-      std::max(0., std::min(FANOUT - 1., pred_cdf * FANOUT)));
-
-    repeated_keys_predicted_ranks[pred_model_idx].push_back(repeated_keys[i]);
-    repeated_key_counts[pred_model_idx].push_back(0);
+    repeated_keys_predicted_ranks[repeated_keys_pred_idx[i]].push_back(
+      repeated_keys[i]);
+    repeated_key_counts[repeated_keys_pred_idx[i]].push_back(0);
   }
 
   if (repeated_keys.size() ==
       0) {  // No significantly repeated keys in the sample
-    pred_model_idx = 0;
-
-    // Process each key in order
-    for (auto cur_key = begin; cur_key < end; ++cur_key) {
-      // Predict the model idx in the leaf layer
-      pred_model_idx = static_cast<int>(std::max(
-        0.,
-        std::min(num_models - 1., root_slope * cur_key[0] + root_intrcpt)));
-
-      // Predict the CDF
-      pred_cdf =
-        slopes[pred_model_idx] * cur_key[0] + intercepts[pred_model_idx];
-
-      // Scale the CDF to the number of buckets
-      pred_model_idx = static_cast<int>(
-        std::max(0., std::min(FANOUT - 1., pred_cdf * FANOUT)));
-
-      if (major_bckt_sizes[pred_model_idx] <
-        MAJOR_BCKT_CAPACITY) {  // The predicted bucket is not full
-        major_bckts[MAJOR_BCKT_CAPACITY * pred_model_idx +
-          major_bckt_sizes[pred_model_idx]] = cur_key[0];
-
-        // Update the bucket size
-        ++major_bckt_sizes[pred_model_idx];
-      } else {  // The predicted bucket is full, place in the spill bucket
-        spill_bucket.push_back(cur_key[0]);
+
+    // Batch size for the bucket predictions
+    static constexpr unsigned int BATCH_SZ_PRED = 256;
+
+    // Stores the predicted bucket for each input key in the current batch
+    unsigned int pred_idx_in_batch[BATCH_SZ_PRED];
+
+    // Process the keys in order, predicting a batch at a time
+    for (auto cur_key = begin; cur_key < end; cur_key += BATCH_SZ_PRED) {
+      // The last batch may be incomplete
+      const unsigned int batch_sz_pred = std::min<unsigned int>(
+          BATCH_SZ_PRED, std::distance(cur_key, end));
+
+      // Predict the buckets of the batch
+      predict(&cur_key[0], batch_sz_pred, FANOUT, 0., FANOUT - 1.,
+              pred_idx_in_batch);
+
+      for (unsigned int elm_idx = 0; elm_idx < batch_sz_pred; ++elm_idx) {
+        const unsigned int pred_model_idx = pred_idx_in_batch[elm_idx];
+
+        if (major_bckt_sizes[pred_model_idx] <
+          MAJOR_BCKT_CAPACITY) {  // The predicted bucket is not full
+          major_bckts[MAJOR_BCKT_CAPACITY * pred_model_idx +
+            major_bckt_sizes[pred_model_idx]] = cur_key[elm_idx];
+
+          // Update the bucket size
+          ++major_bckt_sizes[pred_model_idx];
+        } else {  // The predicted bucket is full, place in the spill bucket
+          spill_bucket.push_back(cur_key[elm_idx]);
+        }
       }
     }
   } else {  // There are many repeated keys in the sample
@@ -540,28 +636,20 @@ void _sort_trained(RandomIt begin, RandomIt end,
 
     // Process elements in batches of size BATCH_SZ_EXP
     for (auto cur_key = begin; cur_key < end; cur_key += BATCH_SZ_EXP) {
-      // Process each element in the batch and save their predicted indices
-      for (unsigned int elm_idx = 0; elm_idx < BATCH_SZ_EXP; ++elm_idx) {
-        // Predict the leaf model idx
-        pred_idx_in_batch_exc[elm_idx] = static_cast<int>(std::max(
-          0., std::min(num_models - 1.,
-                       root_slope * cur_key[elm_idx] + root_intrcpt)));
-
-        // Predict the CDF
-        pred_cdf = slopes[pred_idx_in_batch_exc[elm_idx]] * cur_key[elm_idx] +
-          intercepts[pred_idx_in_batch_exc[elm_idx]];
+      // The last batch may be incomplete
+      const unsigned int batch_sz_exp = std::min<unsigned int>(
+          BATCH_SZ_EXP, std::distance(cur_key, end));
 
-        // Extrapolate the CDF to the number of buckets
-        pred_idx_in_batch_exc[elm_idx] = static_cast<unsigned int>(
-          std::max(0., std::min(FANOUT - 1., pred_cdf * FANOUT)));
-      }
+      // Predict the buckets of the batch
+      predict(&cur_key[0], batch_sz_exp, FANOUT, 0., FANOUT - 1.,
+              pred_idx_in_batch_exc);
 
       // Go over the batch again and place the flagged keys in an exception
       // list
       bool exc_found = false;  // If exceptions in the batch, don't insert into
       // buckets, but save in an exception list
 
-      for (unsigned int elm_idx = 0; elm_idx < BATCH_SZ_EXP; ++elm_idx) {
+      for (unsigned int elm_idx = 0; elm_idx < batch_sz_exp; ++elm_idx) {
         exc_found = false;
 
         // Iterate over the keys in the exception list corresponding to the
@@ -618,7 +706,7 @@ void _sort_trained(RandomIt begin, RandomIt end,
   int bckt_start_offset = 0;
 
   // Stores the predicted CDF values for the elements in the current bucket
-  unsigned int pred_idx_cache[THRESHOLD];
+  vector<unsigned int> pred_idx_cache(THRESHOLD);
 
   // Caches the predicted bucket indices for each element in the batch
   vector<unsigned int> batch_cache(BATCH_SZ, 0);
@@ -641,27 +729,11 @@ void _sort_trained(RandomIt begin, RandomIt end,
 
     // Iterate over the elements in the current bucket in batch-mode
     for (unsigned int batch_idx = 0; batch_idx < num_batches; ++batch_idx) {
-      // Iterate over the elements in the batch and store their predicted
-      // ranks
-      for (unsigned int elm_idx = 0; elm_idx < BATCH_SZ; ++elm_idx) {
-        // Find the current element
-        auto cur_elm = major_bckts[bckt_start_offset + elm_idx];
-
-        // Predict the leaf-layer model
-        batch_cache[elm_idx] = static_cast<int>(std::max(
-          0.,
-          std::min(num_models - 1., root_slope * cur_elm + root_intrcpt)));
-
-        // Predict the CDF
-        pred_cdf = slopes[batch_cache[elm_idx]] * cur_elm +
-          intercepts[batch_cache[elm_idx]];
-
-        // Scale the predicted CDF to the number of minor buckets and cache it
-        batch_cache[elm_idx] = static_cast<int>(std::max(
-          0., std::min(NUM_MINOR_BCKT_PER_MAJOR_BCKT - 1.,
-                       pred_cdf * TOT_NUM_MINOR_BCKTS -
-                         major_bckt_idx * NUM_MINOR_BCKT_PER_MAJOR_BCKT)));
-      }
+      // Predict the minor buckets of the elements in the batch, scaled to
+      // the number of minor buckets
+      predict(&major_bckts[bckt_start_offset], BATCH_SZ, TOT_NUM_MINOR_BCKTS,
+              major_bckt_idx * NUM_MINOR_BCKT_PER_MAJOR_BCKT,
+              NUM_MINOR_BCKT_PER_MAJOR_BCKT - 1., batch_cache.data());
 
       // Iterate over the elements in the batch again, and place them in the
       // sub-buckets, or spill bucket
@@ -694,17 +766,9 @@ void _sort_trained(RandomIt begin, RandomIt end,
     unsigned int num_remaining_elm =
       major_bckt_sizes[major_bckt_idx] - num_batches * BATCH_SZ;
 
-    for (unsigned int elm_idx = 0; elm_idx < num_remaining_elm; ++elm_idx) {
-      auto cur_elm = major_bckts[bckt_start_offset + elm_idx];
-      batch_cache[elm_idx] = static_cast<int>(std::max(
-        0., std::min(num_models - 1., root_slope * cur_elm + root_intrcpt)));
-      pred_cdf = slopes[batch_cache[elm_idx]] * cur_elm +
-        intercepts[batch_cache[elm_idx]];
-      batch_cache[elm_idx] = static_cast<int>(std::max(
-        0., std::min(NUM_MINOR_BCKT_PER_MAJOR_BCKT - 1.,
-                     pred_cdf * TOT_NUM_MINOR_BCKTS -
-                       major_bckt_idx * NUM_MINOR_BCKT_PER_MAJOR_BCKT)));
-    }
+    predict(&major_bckts[bckt_start_offset], num_remaining_elm,
+            TOT_NUM_MINOR_BCKTS, major_bckt_idx * NUM_MINOR_BCKT_PER_MAJOR_BCKT,
+            NUM_MINOR_BCKT_PER_MAJOR_BCKT - 1., batch_cache.data());
 
     for (unsigned elm_idx = 0; elm_idx < num_remaining_elm; ++elm_idx) {
       auto cur_elm = major_bckts[bckt_start_offset + elm_idx];
@@ -742,66 +806,47 @@ void _sort_trained(RandomIt begin, RandomIt end,
          * O(num_layer) to O(1).
          */
 
+        // std::fma like the root model of rmi_predictor
         int pred_model_first_elm = static_cast<int>(std::max(
           0., std::min(num_models - 1.,
-                       root_slope * minor_bckts[bckt_idx * THRESHOLD] +
-                         root_intrcpt)));
+                       std::fma(root_slope,
+                                static_cast<double>(minor_bckts[bckt_idx * THRESHOLD]),
+                                root_intrcpt))));
 
         int pred_model_last_elm = static_cast<int>(std::max(
           0.,
           std::min(num_models - 1.,
-                   root_slope * minor_bckts[bckt_idx * THRESHOLD +
-                     minor_bckt_sizes[bckt_idx] - 1] +
-                     root_intrcpt)));
+                   std::fma(root_slope,
+                            static_cast<double>(minor_bckts[bckt_idx * THRESHOLD +
+                              minor_bckt_sizes[bckt_idx] - 1]),
+                            root_intrcpt))));
 
         if (pred_model_first_elm ==
             pred_model_last_elm) {  // Avoid CDF model traversal and predict the
-          // CDF only using the leaf model
-
-          // Iterate over the elements and place them into the minor buckets
-          for (unsigned int elm_idx = 0; elm_idx < minor_bckt_sizes[bckt_idx];
-          ++elm_idx) {
-            // Find the current element
-            auto cur_elm = minor_bckts[bckt_idx * THRESHOLD + elm_idx];
-
-            // Predict the CDF
-            pred_cdf = slopes[pred_model_first_elm] * cur_elm +
-              intercepts[pred_model_first_elm];
-
-            // Scale the predicted CDF to the input size and cache it
-            pred_idx_cache[elm_idx] = static_cast<int>(std::max(
-              0., std::min(THRESHOLD - 1.,
-                           (pred_cdf * INPUT_SZ) - bckt_start_offset)));
-
-            // Update the counts
-            ++cnt_hist[pred_idx_cache[elm_idx]];
-          }
+          // CDF only using the leaf model (a model without root layer)
+          const rmi_predictor<T> predict_leaf(
+            0., 0., 1, &slopes[pred_model_first_elm],
+            &intercepts[pred_model_first_elm]);
+
+          // Scale the predicted CDF to the input size and cache it
+          predict_leaf(&minor_bckts[bckt_idx * THRESHOLD],
+                       minor_bckt_sizes[bckt_idx], INPUT_SZ,
+                       bckt_start_offset, THRESHOLD - 1.,
+                       pred_idx_cache.data());
         } else {  // Fully traverse the CDF model again to predict the CDF of
           // the
           // current element
 
-          // Iterate over the elements and place them into the minor buckets
-          for (unsigned int elm_idx = 0; elm_idx < minor_bckt_sizes[bckt_idx];
-          ++elm_idx) {
-            // Find the current element
-            auto cur_elm = minor_bckts[bckt_idx * THRESHOLD + elm_idx];
-
-            // Predict the model idx in the leaf layer
-            auto model_idx_next_layer = static_cast<int>(
-              std::max(0., std::min(num_models - 1.,
-                                    root_slope * cur_elm + root_intrcpt)));
-            // Predict the CDF
-            pred_cdf = slopes[model_idx_next_layer] * cur_elm +
-              intercepts[model_idx_next_layer];
-
-            // Scale the predicted CDF to the input size and cache it
-            pred_idx_cache[elm_idx] = static_cast<unsigned int>(std::max(
-              0., std::min(THRESHOLD - 1.,
-                           (pred_cdf * INPUT_SZ) - bckt_start_offset)));
-
-            // Update the counts
-            ++cnt_hist[pred_idx_cache[elm_idx]];
-          }
+          // Scale the predicted CDF to the input size and cache it
+          predict(&minor_bckts[bckt_idx * THRESHOLD],
+                  minor_bckt_sizes[bckt_idx], INPUT_SZ, bckt_start_offset,
+                  THRESHOLD - 1., pred_idx_cache.data());
+        }
+
+        // Update the counts
+        for (unsigned int elm_idx = 0; elm_idx < minor_bckt_sizes[bckt_idx];
+        ++elm_idx) {
+          ++cnt_hist[pred_idx_cache[elm_idx]];
         }
 
         --cnt_hist[0];
@@ -862,15 +907,23 @@ void _sort_trained(RandomIt begin, RandomIt end,
   //               PLACE BACK THE EXCEPTION VALUES            //
   //----------------------------------------------------------//
 
-  vector<T> linear_vals, linear_count;
+  vector<T> linear_vals;
+  vector<unsigned int> linear_count;
 
-  for (auto val_idx = 0; val_idx < EXCEPTION_VEC_INIT_CAPACITY; ++val_idx) {
+  // NOTE: the repeated keys were collected in sorted order (from the sorted
+  // training sample), the buckets only serve the lookup. Walking the buckets
+  // would break that order wherever the model is not monotone.
+  for (size_t i = 0; i < repeated_keys.size(); ++i) {
+    const unsigned int val_idx = repeated_keys_pred_idx[i];
     for (size_t exc_elm_idx = 0;
          exc_elm_idx < repeated_keys_predicted_ranks[val_idx].size();
          ++exc_elm_idx) {
-      linear_vals.push_back(
-        repeated_keys_predicted_ranks[val_idx][exc_elm_idx]);
-      linear_count.push_back(repeated_key_counts[val_idx][exc_elm_idx]);
+      if (repeated_keys_predicted_ranks[val_idx][exc_elm_idx] ==
+          repeated_keys[i]) {
+        linear_vals.push_back(repeated_keys[i]);
+        linear_count.push_back(repeated_key_counts[val_idx][exc_elm_idx]);
+        break;
+      }
     }
   }
 
@@ -903,7 +956,7 @@ void _sort_trained(RandomIt begin, RandomIt end,
       ptr++;
       input_idx++;
     } else {
-      for (int i = 0; i < linear_count[exc_idx]; i++) {
+      for (unsigned int i = 0; i < linear_count[exc_idx]; i++) {
         begin[ptr + i] = linear_vals[exc_idx];
       }
       ptr += linear_count[exc_idx];
@@ -912,7 +965,7 @@ void _sort_trained(RandomIt begin, RandomIt end,
   }
 
   while (exc_idx < linear_vals.size()) {
-    for (int i = 0; i < linear_count[exc_idx]; i++) {
+    for (unsigned int i = 0; i < linear_count[exc_idx]; i++) {
       begin[ptr + i] = linear_vals[exc_idx];
     }
     ptr += linear_count[exc_idx];
@@ -926,6 +979,10 @@ void _sort_trained(RandomIt begin, RandomIt end,
   }
 
   // The input array is now sorted
+  sort_stats stats;
+  stats.n_spill = spill_bucket.size();
+  stats.n_exceptions = total_repeated_keys;
+  return stats;
 }
 
 /**
@@ -943,12 +1000,16 @@ void _sort_trained(RandomIt begin, RandomIt end,
  * not the element pointed by last.
  * @param params The hyperparameters for the CDF model, which describe the
  * architecture and sampling ratio.
+ * @return learned_sort::sort_stats The number of keys that went to the spill
+ * bucket and the number of repeated keys (exceptions).
  */
 template <class RandomIt>
-void learned_sort::sort(
+sort_stats learned_sort::sort(
     RandomIt begin, RandomIt end,
     typename RMI<typename iterator_traits<RandomIt>::value_type>::Params
   &params) {
+  sort_stats stats;
+
   // Use std::sort for very small arrays
   if (std::distance(begin, end) <=
   std::max(params.fanout * params.threshold, 5 * params.arch[1])) {
@@ -959,11 +1020,12 @@ void learned_sort::sort(
 
     // Sort
     if (rmi.trained)
-      _sort_trained(begin, end, rmi);
+      stats = _sort_trained(begin, end, rmi);
 
     else  // Fall back in case the model could not be trained
       std::sort(begin, end);
   }
+  return stats;
 }
 
 /**
@@ -986,4 +1048,143 @@ void learned_sort::sort(RandomIt begin, RandomIt end) {
   learned_sort::sort(begin, end, p);
 }
 
+/**
+ * @brief Sorts a sequence of numerical keys from [begin, end) using Learned
+ * Sort with a model that was trained before (possibly on a different sequence
+ * from the same distribution), in ascending order. Sampling and training are
+ * skipped.
+ *
+ * @tparam RandomIt A bi-directional random iterator over the sequence of keys
+ * @param begin Random-access iterators to the initial position of the sequence
+ * to be used for sorting.
+ * @param end Random-access iterators to the last position of the sequence to be
+ * used for sorting.
+ * @param rmi The trained CDF model, its hyperparameters are used unchanged.
+ * @return learned_sort::sort_stats The number of keys that the model failed to
+ * place (spill bucket) and the number of repeated keys. A high spill rate
+ * indicates that the model no longer fits the data.
+ */
+template <class RandomIt>
+sort_stats learned_sort::sort(
+    RandomIt begin, RandomIt end,
+    RMI<typename iterator_traits<RandomIt>::value_type> &rmi) {
+  const size_t INPUT_SZ = std::distance(begin, end);
+
+  // Use std::sort for very small arrays or if the model is not usable
+  if (!rmi.trained ||
+      INPUT_SZ <= std::max(rmi.hp.fanout * rmi.hp.threshold,
+                           5 * rmi.hp.arch[1])) {
+    std::sort(begin, end);
+    return sort_stats();
+  }
+  return _sort_trained(begin, end, rmi);
+}
+
+/**
+ * @brief Flattens a CDF model into a vector of doubles, such that it can be
+ * stored and reused in another process. The layout is: version (major, minor),
+ * trained flag, batch size, fanout, overallocation ratio, sampling rate,
+ * threshold, number of layers, the layer sizes, slope and intercept of each
+ * model, the size of the training sample and the training sample (which is
+ * needed to detect repeated keys).
+ *
+ * @tparam T The key type, must be representable as double
+ * @param rmi The (trained) CDF model
+ * @return vector<double> The flat representation of the model
+ */
+template <class T>
+vector<double> learned_sort::serialize(const RMI<T> &rmi) {
+  vector<double> v;
+  v.push_back(LEARNED_SORT_VERSION_MAJOR);
+  v.push_back(LEARNED_SORT_VERSION_MINOR);
+  v.push_back(rmi.trained);
+  v.push_back(rmi.hp.batch_sz);
+  v.push_back(rmi.hp.fanout);
+  v.push_back(rmi.hp.overallocation_ratio);
+  v.push_back(rmi.hp.sampling_rate);
+  v.push_back(rmi.hp.threshold);
+  v.push_back(rmi.hp.arch.size());
+  for (auto a : rmi.hp.arch) v.push_back(a);
+  for (const auto &layer : rmi.models) {
+    for (const auto &m : layer) {
+      v.push_back(m.slope);
+      v.push_back(m.intercept);
+    }
+  }
+  v.push_back(rmi.training_sample.size());
+  for (const auto &x : rmi.training_sample) v.push_back(x);
+  return v;
+}
+
+/**
+ * @brief Restores a CDF model from the flat representation created by
+ * learned_sort::serialize().
+ *
+ * @tparam T The key type
+ * @param v Pointer to the flat representation
+ * @param len Number of doubles in the flat representation
+ * @return learned_sort::RMI The restored model
+ * @throws std::invalid_argument if the representation is malformed or was
+ * written by a different major version
+ */
+template <class T>
+RMI<T> learned_sort::deserialize(const double *v, size_t len) {
+  size_t pos = 0;
+  auto next = [&]() -> double {
+    if (pos >= len)
+      throw std::invalid_argument("learned_sort: truncated serialized model");
+    return v[pos++];
+  };
+  // a count or size: finite, integral and representable in unsigned int
+  auto next_count = [&]() -> unsigned int {
+    double x = next();
+    if (!(x >= 0 && x <= std::numeric_limits<unsigned int>::max()) || x != std::floor(x))
+      throw std::invalid_argument("learned_sort: invalid count in serialized model");
+    return static_cast<unsigned int>(x);
+  };
+
+  if (next() != LEARNED_SORT_VERSION_MAJOR)
+    throw std::invalid_argument("learned_sort: incompatible serialized model");
+  next();  // minor version, layout is unchanged within a major version
+
+  typename RMI<T>::Params p;
+  bool trained = next() != 0;
+  p.batch_sz = next_count();
+  p.fanout = next_count();
+  p.overallocation_ratio = next();
+  p.sampling_rate = next();
+  p.threshold = next_count();
+  const size_t NUM_LAYERS = next_count();
+  if (NUM_LAYERS != 2)
+    throw std::invalid_argument("learned_sort: invalid model architecture");
+  p.arch.resize(NUM_LAYERS);
+  for (auto &a : p.arch) a = next_count();
+  if (p.arch[0] != 1 || p.arch[1] == 0 || p.fanout == 0 || p.batch_sz == 0 ||
+      p.threshold == 0 || !(p.overallocation_ratio > 1) ||
+      !std::isfinite(p.overallocation_ratio) || !(p.sampling_rate > 0) ||
+      !(p.sampling_rate <= 1))
+    throw std::invalid_argument("learned_sort: invalid model parameters");
+  // the models and the sample size must be there before anything is allocated
+  if (len - pos < 2 * (static_cast<size_t>(p.arch[0]) + p.arch[1]) + 1)
+    throw std::invalid_argument("learned_sort: truncated serialized model");
+
+  RMI<T> rmi(p);
+  for (auto &layer : rmi.models) {
+    for (auto &m : layer) {
+      m.slope = next();
+      m.intercept = next();
+      if (!std::isfinite(m.slope) || !std::isfinite(m.intercept))
+        throw std::invalid_argument("learned_sort: invalid model coefficients");
+    }
+  }
+  const double SAMPLE_SZ_D = next();
+  if (SAMPLE_SZ_D != static_cast<double>(len - pos))
+    throw std::invalid_argument("learned_sort: invalid training sample size");
+  const size_t SAMPLE_SZ = len - pos;
+  rmi.training_sample.resize(SAMPLE_SZ);
+  for (auto &x : rmi.training_sample) x = static_cast<T>(next());
+  rmi.trained = trained;
+  return rmi;
+}
+
 #endif  // LEARNED_SORT_H
@@ -0,0 +1,266 @@
+#ifndef LEARNED_SORT_PARALLEL_H
+#define LEARNED_SORT_PARALLEL_H
+
+/**
+ * @file learned_sort_parallel.h
+ * @brief A multi-threaded variant of Learned Sort.
+ *
+ * The model is trained sequentially as in learned_sort::sort(). Then
+ *
+ * 1. every thread predicts the major bucket of the keys in its chunk of the
+ *    input and counts them per bucket,
+ * 2. the per-thread counts are turned into per-thread bucket cursors by a
+ *    prefix sum, and every thread scatters its keys into a buffer (the
+ *    buckets are sized exactly, hence there is no spill on the first level),
+ * 3. the threads take the major buckets from a shared counter and sort each
+ *    with the model-based counting sort back into the input followed by an
+ *    insertion sort touch-up. Buckets that are much larger than expected or
+ *    need too many touch-up moves fall back to std::sort; buckets holding a
+ *    single (repeated) key are copied only,
+ * 4. because the piecewise linear model is not strictly monotone at the leaf
+ *    boundaries, the bucket boundaries are checked and repaired sequentially
+ *    with std::inplace_merge where needed.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "learned_sort.h"
+
+namespace learned_sort {
+
+// Multi-threaded Learned Sort, num_threads == 0 uses all hardware threads
+template <class RandomIt>
+sort_stats parallel_sort(
+    RandomIt, RandomIt,
+    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params &,
+    unsigned int num_threads = 0);
+
+// Runs fn(thread_idx) on num_threads threads and waits for them
+template <class F>
+void _run_threads(unsigned int num_threads, F fn) {
+  vector<std::thread> workers;
+  workers.reserve(num_threads - 1);
+  for (unsigned int t = 1; t < num_threads; ++t) workers.emplace_back(fn, t);
+  fn(0);
+  for (auto &w : workers) w.join();
+}
+
+}  // namespace learned_sort
+
+/**
+ * @brief Sorts a sequence of numerical keys from [begin, end) using Learned
+ * Sort on multiple threads, in ascending order.
+ *
+ * @tparam RandomIt A bi-directional random iterator over the sequence of keys
+ * @param begin Random-access iterators to the initial position of the sequence
+ * to be used for sorting.
+ * @param end Random-access iterators to the last position of the sequence to be
+ * used for sorting.
+ * @param params The hyperparameters for the CDF model, fanout is the number of
+ * major buckets, batch size, overallocation ratio and threshold are not used.
+ * @param num_threads The number of threads, 0 uses all hardware threads.
+ * @return learned_sort::sort_stats n_spill counts the keys in buckets that
+ * fell back to std::sort, n_exceptions the keys in single-key buckets.
+ */
+template <class RandomIt>
+sort_stats learned_sort::parallel_sort(
+    RandomIt begin, RandomIt end,
+    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params
+        &params,
+    unsigned int num_threads) {
+  typedef typename iterator_traits<RandomIt>::value_type T;
+
+  const size_t INPUT_SZ = std::distance(begin, end);
+  sort_stats stats;
+
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Use std::sort for very small arrays
+  if (INPUT_SZ <=
+      std::max(params.fanout * params.threshold, 5 * params.arch[1])) {
+    std::sort(begin, end);
+    return stats;
+  }
+
+  //----------------------------------------------------------//
+  //                          TRAIN                           //
+  //----------------------------------------------------------//
+
+  RMI<T> rmi = train(begin, end, params);
+  if (!rmi.trained) {  // Fall back in case the model could not be trained
+    std::sort(begin, end);
+    return stats;
+  }
+
+  const unsigned int FANOUT = rmi.hp.fanout;
+  const unsigned int num_models = rmi.hp.arch[1];
+  const double root_slope = rmi.models[0][0].slope;
+  const double root_intrcpt = rmi.models[0][0].intercept;
+  vector<double> slopes, intercepts;
+  for (unsigned int i = 0; i < num_models; ++i) {
+    slopes.push_back(rmi.models[1][i].slope);
+    intercepts.push_back(rmi.models[1][i].intercept);
+  }
+
+  // Batched (vectorized) model inference
+  const rmi_predictor<T> predict(root_slope, root_intrcpt, num_models,
+                                 slopes.data(), intercepts.data());
+
+  // Batch size for the bucket predictions
+  constexpr size_t BATCH_SZ_PRED = 256;
+
+  //----------------------------------------------------------//
+  //        COUNT AND SCATTER INTO EXACT MAJOR BUCKETS        //
+  //----------------------------------------------------------//
+
+  num_threads = static_cast<unsigned int>(
+      std::max<size_t>(1, std::min<size_t>(num_threads, INPUT_SZ / FANOUT)));
+
+  // Chunk boundaries of the threads
+  vector<size_t> chunk(num_threads + 1);
+  for (unsigned int t = 0; t <= num_threads; ++t)
+    chunk[t] = INPUT_SZ * t / num_threads;
+
+  // Per-thread bucket counts, later per-thread bucket cursors
+  vector<vector<size_t>> cursor(num_threads, vector<size_t>(FANOUT, 0));
+
+  _run_threads(num_threads, [&](unsigned int t) {
+    auto &cnt = cursor[t];
+    unsigned int pred_idx_in_batch[BATCH_SZ_PRED];
+    for (size_t i = chunk[t]; i < chunk[t + 1]; i += BATCH_SZ_PRED) {
+      const size_t k = std::min(BATCH_SZ_PRED, chunk[t + 1] - i);
+      predict(&begin[i], k, FANOUT, 0., FANOUT - 1., pred_idx_in_batch);
+      for (size_t j = 0; j < k; ++j) ++cnt[pred_idx_in_batch[j]];
+    }
+  });
+
+  // Bucket boundaries and the exclusive prefix sum over (bucket, thread)
+  vector<size_t> bckt_start(FANOUT + 1);
+  size_t sum = 0;
+  for (unsigned int b = 0; b < FANOUT; ++b) {
+    bckt_start[b] = sum;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+      size_t c = cursor[t][b];
+      cursor[t][b] = sum;
+      sum += c;
+    }
+  }
+  bckt_start[FANOUT] = sum;
+
+  vector<T> buffer(INPUT_SZ);
+
+  _run_threads(num_threads, [&](unsigned int t) {
+    auto &cur = cursor[t];
+    unsigned int pred_idx_in_batch[BATCH_SZ_PRED];
+    for (size_t i = chunk[t]; i < chunk[t + 1]; i += BATCH_SZ_PRED) {
+      const size_t k = std::min(BATCH_SZ_PRED, chunk[t + 1] - i);
+      predict(&begin[i], k, FANOUT, 0., FANOUT - 1., pred_idx_in_batch);
+      for (size_t j = 0; j < k; ++j)
+        buffer[cur[pred_idx_in_batch[j]]++] = begin[i + j];
+    }
+  });
+
+  //----------------------------------------------------------//
+  //        MODEL-BASED COUNTING SORT OF EACH BUCKET          //
+  //----------------------------------------------------------//
+
+  // Buckets larger than this are not worth the model and go to std::sort
+  const size_t MAX_MODEL_BCKT_SZ = 16 * (INPUT_SZ / FANOUT) + 64;
+
+  // Touch-up moves per key above which std::sort takes over
+  constexpr size_t TOUCHUP_MOVES_PER_KEY = 8;
+
+  std::atomic<unsigned int> next_bckt(0);
+  std::atomic<size_t> n_fallback(0), n_single(0);
+
+  _run_threads(num_threads, [&](unsigned int) {
+    vector<unsigned int> pred_idx_cache;
+    vector<unsigned int> cnt_hist;
+    size_t my_fallback = 0, my_single = 0;
+
+    for (unsigned int b = next_bckt++; b < FANOUT; b = next_bckt++) {
+      const size_t lo = bckt_start[b], hi = bckt_start[b + 1], m = hi - lo;
+      if (m == 0) continue;
+      auto src = buffer.begin() + lo;
+      auto dst = begin + lo;
+
+      auto mm = std::minmax_element(src, src + m);
+      if (!(*mm.first < *mm.second)) {  // A single (repeated) key
+        std::copy(src, src + m, dst);
+        my_single += m;
+        continue;
+      }
+
+      if (m > MAX_MODEL_BCKT_SZ) {  // The model failed for this bucket
+        std::copy(src, src + m, dst);
+        std::sort(dst, dst + m);
+        my_fallback += m;
+        continue;
+      }
+
+      // Predict the positions within the bucket and count them. The
+      // position is the fractional part of the predicted bucket scaled to
+      // the bucket size, which is consistent with the bucketization even
+      // where the model is biased
+      pred_idx_cache.resize(m);
+      cnt_hist.assign(m, 0);
+      predict(&src[0], m, 1. * FANOUT * m, 1. * b * m, m - 1.,
+              pred_idx_cache.data());
+      for (size_t i = 0; i < m; ++i) ++cnt_hist[pred_idx_cache[i]];
+
+      // Exclusive running totals
+      unsigned int run = 0;
+      for (size_t i = 0; i < m; ++i) {
+        unsigned int c = cnt_hist[i];
+        cnt_hist[i] = run;
+        run += c;
+      }
+
+      // Place the keys at their predicted positions
+      for (size_t i = 0; i < m; ++i) dst[cnt_hist[pred_idx_cache[i]]++] = src[i];
+
+      // Insertion sort touch-up with a limit on the number of moves
+      const size_t move_limit = TOUCHUP_MOVES_PER_KEY * m;
+      size_t moves = 0;
+      for (size_t i = 1; i < m && moves <= move_limit; ++i) {
+        T elm = dst[i];
+        size_t j = i;
+        while (j > 0 && elm < dst[j - 1]) {
+          dst[j] = dst[j - 1];
+          --j;
+        }
+        dst[j] = elm;
+        moves += i - j;
+      }
+      if (moves > move_limit) {  // The model was poor, finish with std::sort
+        std::sort(dst, dst + m);
+        my_fallback += m;
+      }
+    }
+    n_fallback += my_fallback;
+    n_single += my_single;
+  });
+
+  //----------------------------------------------------------//
+  //                REPAIR THE BUCKET BOUNDARIES              //
+  //----------------------------------------------------------//
+
+  for (unsigned int b = 1; b < FANOUT; ++b) {
+    const size_t mid = bckt_start[b], hi = bckt_start[b + 1];
+    if (mid == 0 || mid == hi || !(begin[mid] < begin[mid - 1])) continue;
+    auto lo = std::upper_bound(begin, begin + mid, begin[mid]);
+    std::inplace_merge(lo, begin + mid, begin + hi);
+  }
+
+  stats.n_spill = n_fallback;
+  stats.n_exceptions = n_single;
+  return stats;
+}
+
+#endif  // LEARNED_SORT_PARALLEL_H
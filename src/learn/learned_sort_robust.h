@@ -0,0 +1,402 @@
+#ifndef LEARNED_SORT_ROBUST_H
+#define LEARNED_SORT_ROBUST_H
+
+/**
+ * @file learned_sort_robust.h
+ * @brief A skew-robust variant of Learned Sort for data with mass points
+ * (heavily repeated keys) and heavy-tailed distributions.
+ *
+ * Differences to learned_sort::sort():
+ *
+ * - Every key that is frequent enough in the sample to fill a good part of a
+ *   bucket is a heavy hitter and gets its own equal-key bucket, which needs
+ *   no sorting at all.
+ * - The CDF of the remaining keys is a monotone quantile spline: the knots
+ *   are equidistant quantiles of the sample (plus the heavy hitters), the
+ *   segment of a key is found by binary search and the CDF is linearly
+ *   interpolated within the segment. Unlike the linear leaf models this
+ *   adapts to heavy tails and is monotone, hence the buckets never overlap.
+ * - The keys are counted before they are scattered, so the buckets are sized
+ *   exactly and nothing spills. Instead a bucket falls back to
+ *   pdqsort_branchless if the model error is too large, i.e. the bucket is
+ *   much larger than expected or the insertion sort touch-up after the
+ *   model-based counting sort needs too many moves.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ */
+
+#include <type_traits>
+#include "learned_sort.h"
+#include "../pdq/pdqsort.h"
+
+namespace learned_sort {
+
+// Difference a - b >= 0 of two keys as double. For int and int64 keys the
+// subtraction is done in the unsigned type of the same width, which is exact
+// also for keys spanning more than half of their range (e.g. INT_MIN..INT_MAX),
+// where the subtraction in T would overflow.
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value, double>::type
+key_diff(const T &a, const T &b) {
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<double>(static_cast<U>(static_cast<U>(a) - static_cast<U>(b)));
+}
+template <class T>
+inline typename std::enable_if<!std::is_integral<T>::value, double>::type
+key_diff(const T &a, const T &b) {
+  return a - b;
+}
+
+// Skew-robust Learned Sort
+template <class RandomIt>
+sort_stats robust_sort(
+    RandomIt, RandomIt,
+    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params &);
+
+// Monotone quantile spline CDF with equal-key buckets for heavy hitters
+template <class T>
+class quantile_spline {
+ public:
+  // Minimum number of sample occurrences of a heavy hitter
+  static constexpr size_t MIN_HEAVY_CNT = 4;
+
+  // Trains on a sorted sample, the number of segments is at most num_segments
+  quantile_spline(const vector<T> &sorted_sample, unsigned int num_segments,
+                  unsigned int fanout);
+
+  // Number of buckets (normal buckets and one per heavy hitter)
+  unsigned int num_bckts() const { return fanout + 2 * num_heavy + 1; }
+
+  // Number of heavy hitters
+  unsigned int num_heavy_hitters() const { return num_heavy; }
+
+  // Whether the bucket holds a heavy hitter only
+  bool is_heavy_bckt(unsigned int b) const { return heavy_bckt[b]; }
+
+  // Predicts the bucket of a key
+  unsigned int predict(const T &x) const {
+    const size_t j = upper_knot(x);
+    if (j == 0) return 0;  // Below the first knot
+    const size_t k = j - 1;
+    if (knot_heavy[k] && x == knot_x[k]) {  // A heavy hitter
+      return std::min<unsigned int>(fanout - 1, knot_cdf[k] * fanout) +
+             2 * (knot_nheavy[k] - 1) + 1;
+    }
+    double cdf = knot_cdf[k];
+    if (j < knot_x.size()) {
+      // Clamp to the next knot, such that rounding cannot break monotonicity
+      cdf = std::min(knot_cdf[j], cdf + knot_slope[k] * key_diff(x, knot_x[k]));
+    }
+    return std::min<unsigned int>(fanout - 1, std::max(0., cdf * fanout)) +
+           2 * knot_nheavy[k];
+  }
+
+ private:
+  // The grid cell of a key, monotone in the key
+  size_t grid_cell(const T &x) const {
+    return static_cast<size_t>(
+        std::max(0., std::min(grid_max, (x - grid_min) * grid_scale)));
+  }
+
+  // std::upper_bound over the knots: the grid cell of the key limits the
+  // search to the knots in that cell, which are searched branchless
+  size_t upper_knot(const T &x) const {
+    const size_t c = grid_cell(x);
+    const T *first = knot_x.data() + grid_first[c];
+    const T *base = first;
+    size_t n = grid_first[c + 1] - grid_first[c];
+    if (n == 0) return grid_first[c];
+    while (n > 1) {
+      const size_t half = n / 2;
+      base = (x < base[half]) ? base : base + half;
+      n -= half;
+    }
+    return grid_first[c] + (base - first) + !(x < *base);
+  }
+
+  unsigned int fanout;
+  unsigned int num_heavy;
+  vector<T> knot_x;                   // Sorted knots
+  vector<double> knot_cdf;            // CDF at the knots
+  vector<double> knot_slope;          // CDF slope right of the knots
+  vector<unsigned int> knot_nheavy;   // Number of heavy hitters <= knot
+  vector<bool> knot_heavy;            // Whether the knot is a heavy hitter
+  vector<bool> heavy_bckt;            // Whether a bucket is an equal-key bucket
+
+  // Uniform grid over the knot range, grid_first[c] is the first knot in
+  // cell c or later
+  double grid_min;
+  double grid_scale;
+  double grid_max;
+  vector<size_t> grid_first;
+};
+
+}  // namespace learned_sort
+
+template <class T>
+learned_sort::quantile_spline<T>::quantile_spline(
+    const vector<T> &sorted_sample, unsigned int num_segments,
+    unsigned int fanout)
+    : fanout(fanout), num_heavy(0) {
+  const size_t SAMPLE_SZ = sorted_sample.size();
+
+  // A heavy hitter is expected to fill at least half a bucket
+  const size_t HEAVY_CNT_THRESHOLD =
+      std::max<size_t>(MIN_HEAVY_CNT, SAMPLE_SZ / (2 * fanout));
+
+  //----------------------------------------------------------//
+  //                  DETECT THE HEAVY HITTERS                //
+  //----------------------------------------------------------//
+
+  vector<T> heavy, rest;
+  rest.reserve(SAMPLE_SZ);
+  for (size_t i = 0; i < SAMPLE_SZ;) {
+    size_t k = i + 1;
+    while (k < SAMPLE_SZ && !(sorted_sample[i] < sorted_sample[k])) ++k;
+    if (k - i >= HEAVY_CNT_THRESHOLD) {
+      heavy.push_back(sorted_sample[i]);
+    } else {
+      rest.insert(rest.end(), sorted_sample.begin() + i,
+                  sorted_sample.begin() + k);
+    }
+    i = k;
+  }
+  num_heavy = heavy.size();
+
+  //----------------------------------------------------------//
+  //           QUANTILE KNOTS OF THE REMAINING KEYS           //
+  //----------------------------------------------------------//
+
+  vector<T> qx;
+  vector<double> qcdf;
+  if (!rest.empty()) {
+    const size_t K = std::max<size_t>(
+        1, std::min<size_t>(num_segments, rest.size() - 1));
+    for (size_t i = 0; i <= K; ++i) {
+      qx.push_back(rest[(rest.size() - 1) * i / K]);
+      qcdf.push_back(1. * i / K);
+    }
+  }
+
+  // CDF of the remaining keys at x (for placing the heavy hitters)
+  auto rest_cdf = [&](const T &x) -> double {
+    const size_t j = std::upper_bound(qx.begin(), qx.end(), x) - qx.begin();
+    if (j == 0) return 0;
+    if (j == qx.size()) return 1;
+    return qcdf[j - 1] + (qcdf[j] - qcdf[j - 1]) * key_diff(x, qx[j - 1]) /
+                             key_diff(qx[j], qx[j - 1]);
+  };
+
+  //----------------------------------------------------------//
+  //      MERGE THE HEAVY HITTERS INTO THE KNOTS              //
+  //----------------------------------------------------------//
+
+  size_t i = 0, h = 0;
+  unsigned int nheavy = 0;
+  while (i < qx.size() || h < heavy.size()) {
+    if (h < heavy.size() && (i == qx.size() || heavy[h] < qx[i])) {
+      knot_x.push_back(heavy[h]);
+      knot_cdf.push_back(rest_cdf(heavy[h]));
+      knot_heavy.push_back(true);
+      knot_nheavy.push_back(++nheavy);
+      ++h;
+    } else {
+      knot_x.push_back(qx[i]);
+      knot_cdf.push_back(qcdf[i]);
+      knot_heavy.push_back(false);
+      knot_nheavy.push_back(nheavy);
+      ++i;
+    }
+  }
+
+  // Grid with about 4 cells per knot
+  const size_t NUM_CELLS = 4 * knot_x.size() + 1;
+  grid_min = knot_x.empty() ? 0. : knot_x.front();
+  grid_scale = 0;
+  grid_max = NUM_CELLS - 1.;
+  if (!knot_x.empty() && knot_x.front() < knot_x.back()) {
+    grid_scale = NUM_CELLS / (1. * knot_x.back() - grid_min);
+    if (!std::isfinite(grid_scale)) grid_scale = 0;
+  }
+  grid_first.assign(NUM_CELLS + 1, knot_x.size());
+  for (size_t k = knot_x.size(); k-- > 0;) {
+    grid_first[grid_cell(knot_x[k])] = k;
+  }
+  for (size_t c = NUM_CELLS; c-- > 0;) {
+    grid_first[c] = std::min(grid_first[c], grid_first[c + 1]);
+  }
+
+  knot_slope.resize(knot_x.size(), 0.);
+  for (size_t k = 0; k + 1 < knot_x.size(); ++k) {
+    if (knot_x[k] < knot_x[k + 1])
+      knot_slope[k] =
+          (knot_cdf[k + 1] - knot_cdf[k]) / key_diff(knot_x[k + 1], knot_x[k]);
+  }
+
+  heavy_bckt.assign(num_bckts(), false);
+  for (size_t k = 0; k < knot_x.size(); ++k) {
+    if (knot_heavy[k]) {
+      heavy_bckt[predict(knot_x[k])] = true;
+    }
+  }
+}
+
+/**
+ * @brief Sorts a sequence of numerical keys from [begin, end) using the
+ * skew-robust variant of Learned Sort, in ascending order.
+ *
+ * @tparam RandomIt A bi-directional random iterator over the sequence of keys
+ * @param begin Random-access iterators to the initial position of the sequence
+ * to be used for sorting.
+ * @param end Random-access iterators to the last position of the sequence to be
+ * used for sorting.
+ * @param params The hyperparameters, the number of leaf models arch[1] is the
+ * number of spline segments, batch size and overallocation ratio are not used.
+ * @return learned_sort::sort_stats n_spill counts the keys in buckets that
+ * fell back to pdqsort_branchless, n_exceptions the keys in the equal-key
+ * buckets of the heavy hitters.
+ */
+template <class RandomIt>
+sort_stats learned_sort::robust_sort(
+    RandomIt begin, RandomIt end,
+    typename RMI<typename iterator_traits<RandomIt>::value_type>::Params
+        &params) {
+  typedef typename iterator_traits<RandomIt>::value_type T;
+
+  const size_t INPUT_SZ = std::distance(begin, end);
+  sort_stats stats;
+
+  // Use pdqsort for very small arrays
+  if (INPUT_SZ <=
+      std::max(params.fanout * params.threshold, 5 * params.arch[1])) {
+    pdqsort_branchless(begin, end);
+    return stats;
+  }
+
+  _validate_params<T>(params, INPUT_SZ);
+  const unsigned int FANOUT = params.fanout;
+
+  //----------------------------------------------------------//
+  //                    SAMPLE AND TRAIN                      //
+  //----------------------------------------------------------//
+
+  const size_t SAMPLE_SZ = std::min<size_t>(
+      INPUT_SZ, std::max<size_t>(params.sampling_rate * INPUT_SZ,
+                                 RMI<T>::Params::MIN_SORTING_SIZE));
+  const size_t offset = INPUT_SZ / SAMPLE_SZ;
+  vector<T> sample;
+  sample.reserve(SAMPLE_SZ + 1);
+  for (auto i = begin; i < end; i += offset) sample.push_back(*i);
+  pdqsort_branchless(sample.begin(), sample.end());
+
+  const quantile_spline<T> model(sample, params.arch[1], FANOUT);
+  const unsigned int NUM_BCKTS = model.num_bckts();
+
+  //----------------------------------------------------------//
+  //             COUNT AND SCATTER INTO EXACT BUCKETS         //
+  //----------------------------------------------------------//
+
+  vector<size_t> bckt_start(NUM_BCKTS + 1, 0);
+  for (auto it = begin; it < end; ++it) ++bckt_start[model.predict(*it) + 1];
+  for (unsigned int b = 0; b < NUM_BCKTS; ++b)
+    bckt_start[b + 1] += bckt_start[b];
+
+  vector<T> buffer(INPUT_SZ);
+  {
+    vector<size_t> cursor(bckt_start.begin(), bckt_start.end() - 1);
+    for (auto it = begin; it < end; ++it)
+      buffer[cursor[model.predict(*it)]++] = *it;
+  }
+
+  //----------------------------------------------------------//
+  //      MODEL-BASED COUNTING SORT WITH ERROR FALLBACK       //
+  //----------------------------------------------------------//
+
+  // Buckets larger than this exceed the error bound of the model
+  const size_t MAX_MODEL_BCKT_SZ = 16 * (INPUT_SZ / FANOUT) + 64;
+
+  // Touch-up moves per key above which the model error is too large
+  constexpr size_t TOUCHUP_MOVES_PER_KEY = 8;
+
+  vector<unsigned int> pred_idx_cache;
+  vector<unsigned int> cnt_hist;
+
+  for (unsigned int b = 0; b < NUM_BCKTS; ++b) {
+    const size_t lo = bckt_start[b], m = bckt_start[b + 1] - lo;
+    if (m == 0) continue;
+    auto src = buffer.begin() + lo;
+    auto dst = begin + lo;
+
+    if (model.is_heavy_bckt(b)) {  // Equal keys, nothing to sort
+      std::copy(src, src + m, dst);
+      stats.n_exceptions += m;
+      continue;
+    }
+
+    if (m == 1) {
+      *dst = *src;
+      continue;
+    }
+
+    if (m > MAX_MODEL_BCKT_SZ) {
+      std::copy(src, src + m, dst);
+      pdqsort_branchless(dst, dst + m);
+      stats.n_spill += m;
+      continue;
+    }
+
+    // A bucket spans a CDF range of 1/FANOUT, which the spline covers with
+    // about one segment, hence the positions within the bucket are predicted
+    // by linear interpolation between the bucket's min and max keys
+    auto mm = std::minmax_element(src, src + m);
+    const T bckt_min = *mm.first;
+    if (!(bckt_min < *mm.second)) {  // Equal keys
+      std::copy(src, src + m, dst);
+      continue;
+    }
+    const double pos_slope = (m - 1.) / key_diff(*mm.second, bckt_min);
+
+    pred_idx_cache.resize(m);
+    cnt_hist.assign(m, 0);
+    for (size_t i = 0; i < m; ++i) {
+      pred_idx_cache[i] = static_cast<unsigned int>(
+          std::max(0., std::min(m - 1., pos_slope * key_diff(src[i], bckt_min))));
+      ++cnt_hist[pred_idx_cache[i]];
+    }
+
+    // Exclusive running totals
+    unsigned int run = 0;
+    for (size_t i = 0; i < m; ++i) {
+      unsigned int c = cnt_hist[i];
+      cnt_hist[i] = run;
+      run += c;
+    }
+
+    // Place the keys at their predicted positions
+    for (size_t i = 0; i < m; ++i) dst[cnt_hist[pred_idx_cache[i]]++] = src[i];
+
+    // Insertion sort touch-up with a limit on the number of moves
+    const size_t move_limit = TOUCHUP_MOVES_PER_KEY * m;
+    size_t moves = 0;
+    for (size_t i = 1; i < m && moves <= move_limit; ++i) {
+      T elm = dst[i];
+      size_t j = i;
+      while (j > 0 && elm < dst[j - 1]) {
+        dst[j] = dst[j - 1];
+        --j;
+      }
+      dst[j] = elm;
+      moves += i - j;
+    }
+    if (moves > move_limit) {  // The model error is too large
+      pdqsort_branchless(dst, dst + m);
+      stats.n_spill += m;
+    }
+  }
+
+  return stats;
+}
+
+#endif  // LEARNED_SORT_ROBUST_H
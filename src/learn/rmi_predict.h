@@ -0,0 +1,166 @@
+#ifndef RMI_PREDICT_H
+#define RMI_PREDICT_H
+
+/**
+ * @file rmi_predict.h
+ * @brief Batched inference of the two-layer RMI used by Learned Sort.
+ *
+ * For a batch of keys the predictor computes
+ *
+ *   leaf   = max(0, min(num_models - 1, root_slope * x + root_intercept))
+ *   cdf    = slopes[leaf] * x + intercepts[leaf]
+ *   out[i] = max(0, min(max_idx, cdf * scale - offset))
+ *
+ * truncated to unsigned int, exactly like the scalar code in learned_sort.h
+ * (including NaN, which ends up at the upper clamp). For double keys on x86
+ * the batch is evaluated 4 (AVX2) or 8 (AVX-512) keys at a time including the
+ * gather of the leaf models; the kernel is chosen once at runtime with
+ * __builtin_cpu_supports, other key types and CPUs use the scalar loop.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RMI_PREDICT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace learned_sort {
+
+template <class T>
+struct rmi_predictor {
+  double root_slope;
+  double root_intercept;
+  double max_leaf;
+  const double *slopes;
+  const double *intercepts;
+
+  // The full two-layer model
+  rmi_predictor(double root_slope, double root_intercept,
+                unsigned int num_models, const double *slopes,
+                const double *intercepts)
+      : root_slope(root_slope),
+        root_intercept(root_intercept),
+        max_leaf(num_models - 1.),
+        slopes(slopes),
+        intercepts(intercepts) {}
+
+  // Writes the scaled and clamped predictions of n keys (max_idx < 2^31)
+  void operator()(const T *keys, size_t n, double scale, double offset,
+                  double max_idx, unsigned int *out) const;
+};
+
+// Scalar reference kernel. It rounds once per multiply-add with std::fma like
+// the fmadd/fmsub of the SIMD kernels (whose tails it handles), hence they
+// agree bit for bit whether or not the compiler contracts floating point code.
+template <class T>
+inline void _rmi_predict_scalar(const rmi_predictor<T> &m, const T *keys,
+                                size_t n, double scale, double offset,
+                                double max_idx, unsigned int *out) {
+  for (size_t i = 0; i < n; ++i) {
+    const double x = static_cast<double>(keys[i]);
+    int leaf = static_cast<int>(std::max(
+        0., std::min(m.max_leaf, std::fma(m.root_slope, x, m.root_intercept))));
+    double cdf = std::fma(m.slopes[leaf], x, m.intercepts[leaf]);
+    out[i] = static_cast<unsigned int>(
+        std::max(0., std::min(max_idx, std::fma(cdf, scale, -offset))));
+  }
+}
+
+#ifdef RMI_PREDICT_X86
+
+// NOTE: _mm*_min_pd(v, hi) returns hi if v is NaN and _mm*_max_pd(v, 0)
+// returns 0, which is the same as std::max(0., std::min(hi, v))
+
+__attribute__((target("avx2,fma"))) inline void _rmi_predict_avx2(
+    const rmi_predictor<double> &m, const double *keys, size_t n, double scale,
+    double offset, double max_idx, unsigned int *out) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d rs = _mm256_set1_pd(m.root_slope);
+  const __m256d ri = _mm256_set1_pd(m.root_intercept);
+  const __m256d ml = _mm256_set1_pd(m.max_leaf);
+  const __m256d sc = _mm256_set1_pd(scale);
+  const __m256d of = _mm256_set1_pd(offset);
+  const __m256d mi = _mm256_set1_pd(max_idx);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(keys + i);
+    __m256d l = _mm256_max_pd(_mm256_min_pd(_mm256_fmadd_pd(rs, x, ri), ml), zero);
+    __m128i leaf = _mm256_cvttpd_epi32(l);
+    __m256d s = _mm256_i32gather_pd(m.slopes, leaf, 8);
+    __m256d c = _mm256_i32gather_pd(m.intercepts, leaf, 8);
+    __m256d cdf = _mm256_fmadd_pd(s, x, c);
+    __m256d p = _mm256_max_pd(_mm256_min_pd(_mm256_fmsub_pd(cdf, sc, of), mi), zero);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_cvttpd_epi32(p));
+  }
+  _rmi_predict_scalar(m, keys + i, n - i, scale, offset, max_idx, out + i);
+}
+
+__attribute__((target("avx512f"))) inline void _rmi_predict_avx512(
+    const rmi_predictor<double> &m, const double *keys, size_t n, double scale,
+    double offset, double max_idx, unsigned int *out) {
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512d rs = _mm512_set1_pd(m.root_slope);
+  const __m512d ri = _mm512_set1_pd(m.root_intercept);
+  const __m512d ml = _mm512_set1_pd(m.max_leaf);
+  const __m512d sc = _mm512_set1_pd(scale);
+  const __m512d of = _mm512_set1_pd(offset);
+  const __m512d mi = _mm512_set1_pd(max_idx);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d x = _mm512_loadu_pd(keys + i);
+    __m512d l = _mm512_max_pd(_mm512_min_pd(_mm512_fmadd_pd(rs, x, ri), ml), zero);
+    __m256i leaf = _mm512_cvttpd_epi32(l);
+    __m512d s = _mm512_i32gather_pd(leaf, m.slopes, 8);
+    __m512d c = _mm512_i32gather_pd(leaf, m.intercepts, 8);
+    __m512d cdf = _mm512_fmadd_pd(s, x, c);
+    __m512d p = _mm512_max_pd(_mm512_min_pd(_mm512_fmsub_pd(cdf, sc, of), mi), zero);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_cvttpd_epi32(p));
+  }
+  _rmi_predict_scalar(m, keys + i, n - i, scale, offset, max_idx, out + i);
+}
+
+#endif  // RMI_PREDICT_X86
+
+typedef void (*_rmi_predict_fn)(const rmi_predictor<double> &, const double *,
+                                size_t, double, double, double,
+                                unsigned int *);
+
+// Picks the widest kernel the CPU supports (once)
+inline _rmi_predict_fn _rmi_predict_dispatch() {
+  static const _rmi_predict_fn fn = []() -> _rmi_predict_fn {
+#ifdef RMI_PREDICT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return _rmi_predict_avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return _rmi_predict_avx2;
+#endif
+    return _rmi_predict_scalar<double>;
+  }();
+  return fn;
+}
+
+template <class T>
+inline void rmi_predictor<T>::operator()(const T *keys, size_t n, double scale,
+                                         double offset, double max_idx,
+                                         unsigned int *out) const {
+  _rmi_predict_scalar(*this, keys, n, scale, offset, max_idx, out);
+}
+
+template <>
+inline void rmi_predictor<double>::operator()(const double *keys, size_t n,
+                                              double scale, double offset,
+                                              double max_idx,
+                                              unsigned int *out) const {
+  _rmi_predict_dispatch()(*this, keys, n, scale, offset, max_idx, out);
+}
+
+}  // namespace learned_sort
+
+#endif  // RMI_PREDICT_H
@@ -0,0 +1,79 @@
+/*
+# greeNsort Header-Code for sorting (key, index) records
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+#*/
+
+/*
+ Order mode: instead of the sorted values the engines return the permutation that sorts them.
+ Each element is carried as a 16 byte record of its key and its original position (AoS), such
+ that the comparison and radix engines move key and index together in one pass. The records
+ compare by key only, hence the stable engines (Peeksort, Powersort, Timsort, LSD-Skasort) keep
+ ties in original order. The unstable engines (IPS4o, Pdqsort, MSD-Skasort) sort by
+ (key, index), which yields the same permutation as a stable sort. Learnsort cannot carry a
+ payload, it sorts the keys alone (SoA) and ranks the records against the sorted keys.
+ NA keys (see sort_na.h) are not sorted, they are put last in original order (like
+ order(x, na.last=TRUE)).
+ The records are templates over the key type: double, int or int64 (see sort_types.h).
+*/
+
+#ifndef ALREADY_DEFINED_order_h
+#define ALREADY_DEFINED_order_h
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// K is double, int or std::int64_t (see sort_types.h), the records have 16 bytes in all cases
+template<class K>
+struct greensort_order_record {
+  K key;
+  std::int64_t index;
+};
+
+template<class K>
+inline bool operator<(const greensort_order_record<K>& a, const greensort_order_record<K>& b) { return a.key < b.key; }
+template<class K>
+inline bool operator>(const greensort_order_record<K>& a, const greensort_order_record<K>& b) { return a.key > b.key; }
+template<class K>
+inline bool operator<=(const greensort_order_record<K>& a, const greensort_order_record<K>& b) { return a.key <= b.key; }
+template<class K>
+inline bool operator>=(const greensort_order_record<K>& a, const greensort_order_record<K>& b) { return a.key >= b.key; }
+
+// Comparator breaking ties by original position (for the unstable engines)
+struct greensort_order_less {
+  template<class K>
+  bool operator()(const greensort_order_record<K>& a, const greensort_order_record<K>& b) const {
+    return a.key < b.key || (!(b.key < a.key) && a.index < b.index);
+  }
+};
+
+enum greensort_order_engine {
+  GREENSORT_ORDER_PEEKSORT = 0
+, GREENSORT_ORDER_POWERSORT = 1
+, GREENSORT_ORDER_TIMSORT = 2
+, GREENSORT_ORDER_PTIMSORT = 3
+, GREENSORT_ORDER_IPS4O = 4
+, GREENSORT_ORDER_IS4O = 5
+, GREENSORT_ORDER_PDQSORT = 6
+, GREENSORT_ORDER_SKASORT = 7
+, GREENSORT_ORDER_ISKASORT = 8
+, GREENSORT_ORDER_LEARNSORT = 9
+};
+
+// Fills rec[0..n) with the records of x, NA last in original order. Returns the number of non-NA.
+// (instantiated for double, int and std::int64_t in Order.cpp)
+template<class K>
+size_t GreensortOrderFill(greensort_order_record<K>* rec, const K* x, size_t n);
+
+// Sorts the records [begin, end) with the engine such that ties remain in the order of
+// increasing index, threads is used by the parallel engines (0 = all cores).
+// NA keys must have been removed before.
+template<class K>
+void GreensortOrderRecords(greensort_order_record<K>* begin, greensort_order_record<K>* end, int engine, int threads);
+
+// Buffer needed by the engine in records per record (for the size column of the measurements)
+double GreensortOrderBuffer(int engine);
+
+#endif
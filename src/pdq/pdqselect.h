@@ -0,0 +1,199 @@
+/*
+ pdqselect.h - Selection, partial sort and multi-selection with pattern-defeating partitioning.
+
+ Builds on pdqsort.h (Copyright (c) 2015 Orson Peters, zlib license, see there) and reuses its
+ median-of-3/pseudomedian-of-9 pivot choice, the partition_left strategy for many equal
+ elements, the (branchless, on numeric keys vectorized) partitioning, the shuffling of highly
+ unbalanced partitions and the partial insertion sort of already partitioned sequences. After
+ too many bad partitions the remaining range is finished by heap selection (or heapsort), which
+ guarantees O(n log n).
+
+ pdqselect(begin, nth, end, comp)
+   introselect like std::nth_element: afterwards *nth is the element that would be there in
+   sorted order, no element of [begin, nth) is greater and no element of (nth, end) is less.
+ pdqpartial_sort(begin, middle, end, comp)
+   like std::partial_sort: [begin, middle) holds the smallest elements in sorted order (top-k).
+ pdqmultiselect(begin, end, k_first, k_last, comp)
+   pdqselect for the sorted, unique offsets [k_first, k_last) with one partitioning pass shared
+   by all offsets (multiple quantiles).
+ */
+
+#ifndef PDQSELECT_H
+#define PDQSELECT_H
+
+#include "pdqsort.h"
+
+namespace pdqsort_detail {
+template<class Iter, class Compare, bool Branchless>
+inline void pdqselect_loop(Iter begin, Iter nth, Iter end, Compare comp, int bad_allowed,
+                           bool leftmost = true) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  typedef is_simd_sortable<Iter, Compare> simd;
+
+  while (true) {
+    diff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+      if (leftmost) insertion_sort(begin, end, comp);
+      else unguarded_insertion_sort(begin, end, comp);
+      return;
+    }
+
+    choose_pivot(begin, end, comp);
+
+    // Elements equal to *(begin - 1) end up in [begin, new begin), they are in place.
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      if (nth < begin) return;
+      continue;
+    }
+
+    std::pair<Iter, bool> part_result =
+      Branchless ? partition_right_simd(begin, end, comp, simd())
+        : partition_right(begin, end, comp);
+    Iter pivot_pos = part_result.first;
+    bool already_partitioned = part_result.second;
+    if (pivot_pos == nth) return;
+
+    diff_t l_size = pivot_pos - begin;
+    diff_t r_size = end - (pivot_pos + 1);
+    bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      // If we had too many bad partitions, switch to heap selection to guarantee O(n log n).
+      if (--bad_allowed == 0) {
+        if (nth < pivot_pos) std::partial_sort(begin, nth + 1, pivot_pos, comp);
+        else std::partial_sort(pivot_pos + 1, nth + 1, end, comp);
+        return;
+      }
+      break_patterns(begin, pivot_pos, end);
+    } else if (already_partitioned) {
+      // Try to finish the side holding nth with insertion sort.
+      if (nth < pivot_pos ? partial_insertion_sort(begin, pivot_pos, comp)
+                          : partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+    }
+
+    if (nth < pivot_pos) end = pivot_pos;
+    else {
+      begin = pivot_pos + 1;
+      leftmost = false;
+    }
+  }
+}
+
+// The offsets [k_first, k_last) are relative to base and lie in [begin, end).
+template<class Iter, class Compare, bool Branchless, class OffsetIter>
+inline void pdqmultiselect_loop(Iter base, Iter begin, Iter end, OffsetIter k_first,
+                                OffsetIter k_last, Compare comp, int bad_allowed,
+                                bool leftmost = true) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  typedef typename std::iterator_traits<OffsetIter>::value_type offset_t;
+  typedef is_simd_sortable<Iter, Compare> simd;
+
+  while (k_first != k_last) {
+    if (k_last - k_first == 1) {
+      pdqselect_loop<Iter, Compare, Branchless>(begin, base + *k_first, end, comp, bad_allowed,
+                                                leftmost);
+      return;
+    }
+
+    diff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+      if (leftmost) insertion_sort(begin, end, comp);
+      else unguarded_insertion_sort(begin, end, comp);
+      return;
+    }
+
+    choose_pivot(begin, end, comp);
+
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      while (k_first != k_last && base + *k_first < begin) ++k_first;
+      continue;
+    }
+
+    std::pair<Iter, bool> part_result =
+      Branchless ? partition_right_simd(begin, end, comp, simd())
+        : partition_right(begin, end, comp);
+    Iter pivot_pos = part_result.first;
+    bool already_partitioned = part_result.second;
+
+    diff_t l_size = pivot_pos - begin;
+    diff_t r_size = end - (pivot_pos + 1);
+    bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      // If we had too many bad partitions, switch to heapsort to guarantee O(n log n).
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp);
+        std::sort_heap(begin, end, comp);
+        return;
+      }
+      break_patterns(begin, pivot_pos, end);
+    } else {
+      if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
+            && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+    }
+
+    // Split the offsets at the pivot, the pivot itself is in place.
+    offset_t p = static_cast<offset_t>(pivot_pos - base);
+    OffsetIter k_mid = std::lower_bound(k_first, k_last, p);
+    OffsetIter k_right = k_mid;
+    if (k_right != k_last && *k_right == p) ++k_right;
+
+    pdqmultiselect_loop<Iter, Compare, Branchless>(base, begin, pivot_pos, k_first, k_mid, comp,
+                                                   bad_allowed, leftmost);
+    begin = pivot_pos + 1;
+    k_first = k_right;
+    leftmost = false;
+  }
+}
+}
+
+
+template<class Iter, class Compare>
+inline void pdqselect(Iter begin, Iter nth, Iter end, Compare comp) {
+  if (nth == end) return;
+  pdqsort_detail::pdqselect_loop<Iter, Compare, false>(
+      begin, nth, end, comp, pdqsort_detail::log2(end - begin));
+}
+
+template<class Iter, class Compare>
+inline void pdqselect_branchless(Iter begin, Iter nth, Iter end, Compare comp) {
+  if (nth == end) return;
+  pdqsort_detail::pdqselect_loop<Iter, Compare, true>(
+      begin, nth, end, comp, pdqsort_detail::log2(end - begin));
+}
+
+template<class Iter, class Compare>
+inline void pdqpartial_sort(Iter begin, Iter middle, Iter end, Compare comp) {
+  if (middle == begin) return;
+  pdqselect(begin, middle - 1, end, comp);
+  pdqsort(begin, middle - 1, comp);
+}
+
+template<class Iter, class Compare>
+inline void pdqpartial_sort_branchless(Iter begin, Iter middle, Iter end, Compare comp) {
+  if (middle == begin) return;
+  pdqselect_branchless(begin, middle - 1, end, comp);
+  pdqsort_branchless(begin, middle - 1, comp);
+}
+
+template<class Iter, class OffsetIter, class Compare>
+inline void pdqmultiselect(Iter begin, Iter end, OffsetIter k_first, OffsetIter k_last,
+                           Compare comp) {
+  if (begin == end) return;
+  pdqsort_detail::pdqmultiselect_loop<Iter, Compare, false>(
+      begin, begin, end, k_first, k_last, comp, pdqsort_detail::log2(end - begin));
+}
+
+template<class Iter, class OffsetIter, class Compare>
+inline void pdqmultiselect_branchless(Iter begin, Iter end, OffsetIter k_first,
+                                      OffsetIter k_last, Compare comp) {
+  if (begin == end) return;
+  pdqsort_detail::pdqmultiselect_loop<Iter, Compare, true>(
+      begin, begin, end, k_first, k_last, comp, pdqsort_detail::log2(end - begin));
+}
+
+#endif
@@ -17,6 +17,9 @@
  !! Attention: Modifications for benchmarking by Jens Oehlschlägel !!
  !! this code has been modified to NOT automatically use the branchless version with C++11 !!
  !! the insertion_sort_threshold has been increased from 24 to 64 !!
+ !! the branchless version partitions double, int64_t and int32_t keys compared with std::less !!
+ !! or std::greater !!
+ !! with the vectorized kernel of pdqsort_simd.h and sorts up to 16 of them with a network !!
  */
 
 
@@ -32,6 +35,7 @@
 #if __cplusplus >= 201103L
 #include <cstdint>
 #include <type_traits>
+#include "pdqsort_simd.h"
 #define PDQSORT_PREFER_MOVE(x) std::move(x)
 #else
 #define PDQSORT_PREFER_MOVE(x) (x)
@@ -332,6 +336,83 @@ inline std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Co
   return std::make_pair(pivot_pos, already_partitioned);
 }
 
+#if __cplusplus >= 201103L
+template<class Iter, class Compare>
+struct is_simd_sortable
+  : pdqsort_simd::is_simd_sortable<Iter, typename std::decay<Compare>::type> { };
+
+// Same as partition_right_branchless, but for numeric keys compared with std::less (or
+// std::greater) the keys between the first and last misplaced element are partitioned with the
+// vectorized kernel.
+template<class Iter, class Compare>
+inline std::pair<Iter, bool> partition_right_simd(Iter begin, Iter end, Compare comp,
+                                                  std::false_type) {
+  return partition_right_branchless(begin, end, comp);
+}
+
+template<class T, class Compare>
+inline std::pair<T*, bool> partition_right_simd(T* begin, T* end, Compare comp,
+                                                std::true_type) {
+  if (!pdqsort_simd::has_partition<T>()) return partition_right_branchless(begin, end, comp);
+
+  T pivot = *begin;
+  T* first = begin;
+  T* last = end;
+
+  // Find the first element greater than or equal than the pivot (the median of 3 guarantees
+  // this exists) and the first element strictly smaller than the pivot from the right.
+  while (comp(*++first, pivot));
+  if (first - 1 == begin) while (first < last && !comp(*--last, pivot));
+  else                    while (                !comp(*--last, pivot));
+
+  // If the first pair of elements that should be swapped to partition are the same element,
+  // the passed in sequence already was correctly partitioned.
+  bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    // Unlike the swaps of the scalar partition, the vectorized partition does not turn a
+    // descending sequence into sorted partitions, hence sample both ends for that pattern.
+    bool descending = last - first > 16;
+    for (int i = 0; i < 8 && descending; ++i)
+      descending = !comp(first[i], first[i + 1]) && !comp(last[-i - 1], last[-i]);
+    if (descending) return partition_right_branchless(begin, end, comp);
+    first = pdqsort_simd::partition<pdqsort_simd::is_descending<Compare>::value>(first, last + 1, pivot);
+  }
+
+  // Put the pivot in the right place.
+  T* pivot_pos = first - 1;
+  *begin = *pivot_pos;
+  *pivot_pos = pivot;
+
+  return std::make_pair(pivot_pos, already_partitioned);
+}
+
+// Sorts small subarrays of numeric keys with a sorting network, returns false otherwise.
+template<class Iter, class Compare>
+inline bool network_sort(Iter, Iter, Compare, std::false_type) {
+  return false;
+}
+
+template<class T, class Compare>
+inline bool network_sort(T* begin, T* end, Compare, std::true_type) {
+  if (end - begin > pdqsort_simd::network_threshold) return false;
+  pdqsort_simd::network_sort<pdqsort_simd::is_descending<Compare>::value>(begin, end - begin);
+  return true;
+}
+#else
+template<class Iter, class Compare>
+struct is_simd_sortable { static const bool value = false; };
+
+template<class Iter, class Compare, class Tag>
+inline std::pair<Iter, bool> partition_right_simd(Iter begin, Iter end, Compare comp, Tag) {
+  return partition_right_branchless(begin, end, comp);
+}
+
+template<class Iter, class Compare, class Tag>
+inline bool network_sort(Iter, Iter, Compare, Tag) {
+  return false;
+}
+#endif
+
 // Partitions [begin, end) around pivot *begin using comparison function comp. Elements equal
 // to the pivot are put in the right-hand partition. Returns the position of the pivot after
 // partitioning and whether the passed sequence already was correctly partitioned. Assumes the
@@ -408,16 +489,70 @@ inline Iter partition_left(Iter begin, Iter end, Compare comp) {
 }
 
 
+// Moves the median of 3 or pseudomedian of 9 of [begin, end) to *begin (as pivot), assumes
+// that [begin, end) is at least 3 long.
+template<class Iter, class Compare>
+inline void choose_pivot(Iter begin, Iter end, Compare comp) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  diff_t size = end - begin;
+  diff_t s2 = size / 2;
+  if (size > ninther_threshold) {
+    sort3(begin, begin + s2, end - 1, comp);
+    sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+    sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+    sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+    std::iter_swap(begin, begin + s2);
+  } else sort3(begin + s2, begin, end - 1, comp);
+}
+
+// Swaps some elements of the partitions [begin, pivot_pos) and (pivot_pos, end) to break the
+// patterns that caused a highly unbalanced partition.
+template<class Iter>
+inline void break_patterns(Iter begin, Iter pivot_pos, Iter end) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  diff_t l_size = pivot_pos - begin;
+  diff_t r_size = end - (pivot_pos + 1);
+
+  if (l_size >= insertion_sort_threshold) {
+    std::iter_swap(begin,             begin + l_size / 4);
+    std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+
+    if (l_size > ninther_threshold) {
+      std::iter_swap(begin + 1,         begin + (l_size / 4 + 1));
+      std::iter_swap(begin + 2,         begin + (l_size / 4 + 2));
+      std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+      std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+    }
+  }
+
+  if (r_size >= insertion_sort_threshold) {
+    std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+    std::iter_swap(end - 1,                   end - r_size / 4);
+
+    if (r_size > ninther_threshold) {
+      std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+      std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+      std::iter_swap(end - 2,             end - (1 + r_size / 4));
+      std::iter_swap(end - 3,             end - (2 + r_size / 4));
+    }
+  }
+}
+
 template<class Iter, class Compare, bool Branchless>
 inline void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bool leftmost = true) {
   typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  typedef is_simd_sortable<Iter, Compare> simd;
 
   // Use a while loop for tail recursion elimination.
   while (true) {
     diff_t size = end - begin;
 
+    // A sorting network is faster for small arrays of numeric keys, which are hence
+    // partitioned down to the size of the network instead of insertion sorted.
+    if (Branchless && network_sort(begin, end, comp, simd())) return;
+
     // Insertion sort is faster for small arrays.
-    if (size < insertion_sort_threshold) {
+    if (size < insertion_sort_threshold && !(Branchless && simd::value)) {
       if (leftmost) insertion_sort(begin, end, comp);
       else unguarded_insertion_sort(begin, end, comp);
       return;
@@ -426,14 +561,7 @@ inline void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bo
     //greeNsort test:  if (partial_insertion_sort(begin, end, comp)) return;
 
     // Choose pivot as median of 3 or pseudomedian of 9.
-    diff_t s2 = size / 2;
-    if (size > ninther_threshold) {
-      sort3(begin, begin + s2, end - 1, comp);
-      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
-      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
-      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
-      std::iter_swap(begin, begin + s2);
-    } else sort3(begin + s2, begin, end - 1, comp);
+    choose_pivot(begin, end, comp);
 
     // If *(begin - 1) is the end of the right partition of a previous partition operation
     // there is no element in [begin, end) that is smaller than *(begin - 1). Then if our
@@ -447,7 +575,7 @@ inline void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bo
 
     // Partition and get results.
     std::pair<Iter, bool> part_result =
-      Branchless ? partition_right_branchless(begin, end, comp)
+      Branchless ? partition_right_simd(begin, end, comp, simd())
         : partition_right(begin, end, comp);
     Iter pivot_pos = part_result.first;
     bool already_partitioned = part_result.second;
@@ -466,29 +594,7 @@ inline void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bo
         return;
       }
 
-      if (l_size >= insertion_sort_threshold) {
-        std::iter_swap(begin,             begin + l_size / 4);
-        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
-
-        if (l_size > ninther_threshold) {
-          std::iter_swap(begin + 1,         begin + (l_size / 4 + 1));
-          std::iter_swap(begin + 2,         begin + (l_size / 4 + 2));
-          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
-          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
-        }
-      }
-
-      if (r_size >= insertion_sort_threshold) {
-        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
-        std::iter_swap(end - 1,                   end - r_size / 4);
-
-        if (r_size > ninther_threshold) {
-          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
-          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
-          std::iter_swap(end - 2,             end - (1 + r_size / 4));
-          std::iter_swap(end - 3,             end - (2 + r_size / 4));
-        }
-      }
+      break_patterns(begin, pivot_pos, end);
     } else {
       // If we were decently balanced and we tried to sort an already partitioned
       // sequence try to use insertion sort.
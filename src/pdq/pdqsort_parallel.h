@@ -0,0 +1,345 @@
+/*
+ pdqsort_parallel.h - Parallel pattern-defeating quicksort.
+
+ Builds on pdqsort.h (Copyright (c) 2015 Orson Peters, zlib license, see there) and keeps its
+ median-of-3/pseudomedian-of-9 pivot choice, the partition_left strategy for many equal
+ elements, the shuffling of highly unbalanced partitions, the heapsort fallback after too many
+ bad partitions and the partial insertion sort of already partitioned sequences.
+
+ Parallelization:
+ 1. The top levels (subranges larger than n / num_threads) are partitioned by a team of threads:
+    every thread partitions its chunk locally (branchless Lomuto), then the elements on the wrong
+    side of the global split point are swapped in parallel.
+ 2. The remaining subranges are sorted by a pool of threads with work-stealing: each worker
+    partitions large subranges itself, pushes the left part to its own deque and continues with
+    the right part; idle workers steal the oldest (largest) subranges of other workers. Below
+    parallel_split_threshold a subrange is sorted sequentially with pdqsort_loop.
+ */
+
+#ifndef PDQSORT_PARALLEL_H
+#define PDQSORT_PARALLEL_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <thread>
+#include <vector>
+
+#include "pdqsort.h"
+
+namespace pdqsort_detail {
+namespace parallel {
+enum {
+  // Inputs below this size are sorted sequentially.
+  parallel_threshold = 1 << 16,
+
+  // Subranges below this size are not split further by the workers.
+  parallel_split_threshold = 1 << 14
+};
+
+template<class Iter>
+struct task {
+  Iter begin;
+  Iter end;
+  int bad_allowed;
+  bool leftmost;
+};
+
+// The bookkeeping of pdqsort_loop after a partition: shuffles a highly unbalanced partition or
+// tries a partial insertion sort of an already partitioned one. Returns true if [begin, end)
+// is sorted (heapsort fallback or successful insertion sort).
+template<class Iter, class Compare>
+inline bool after_partition(Iter begin, Iter end, Iter pivot_pos, bool already_partitioned,
+                            Compare comp, int& bad_allowed) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  diff_t size = end - begin;
+  diff_t l_size = pivot_pos - begin;
+  diff_t r_size = end - (pivot_pos + 1);
+  bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+  if (highly_unbalanced) {
+    if (--bad_allowed == 0) {
+      std::make_heap(begin, end, comp);
+      std::sort_heap(begin, end, comp);
+      return true;
+    }
+
+    break_patterns(begin, pivot_pos, end);
+  } else {
+    if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
+          && partial_insertion_sort(pivot_pos + 1, end, comp)) return true;
+  }
+  return false;
+}
+
+// Partitions [first, last) so that elements less than the pivot come first (branchless Lomuto:
+// [lt, it) only holds elements not less than the pivot, so the unconditional swap is harmless).
+template<class Iter, class Compare, class T>
+inline Iter lomuto_partition(Iter first, Iter last, const T& pivot, Compare comp) {
+  Iter lt = first;
+  for (Iter it = first; it != last; ++it) {
+    T x = std::move(*it);
+    bool c = comp(x, pivot);
+    *it = std::move(*lt);
+    *lt = std::move(x);
+    lt += c;
+  }
+  return lt;
+}
+
+// Runs fn(thread_idx) on num_threads threads and waits for them.
+template<class F>
+inline void run_team(int num_threads, F fn) {
+  std::vector<std::thread> team;
+  team.reserve(num_threads - 1);
+  for (int t = 1; t < num_threads; ++t) team.emplace_back(fn, t);
+  fn(0);
+  for (auto& th : team) th.join();
+}
+
+// Partitions [begin, end) around pivot *begin with num_threads threads, elements equal to the
+// pivot go to the right like in partition_right. Returns the pivot position and whether the
+// sequence already was partitioned.
+template<class Iter, class Compare>
+inline std::pair<Iter, bool> partition_right_parallel(Iter begin, Iter end, Compare comp,
+                                                      int num_threads) {
+  typedef typename std::iterator_traits<Iter>::value_type T;
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+
+  const T pivot(*begin);
+  Iter first = begin + 1;
+  const diff_t n = end - first;
+
+  // 1. Local partition of the chunks.
+  std::vector<Iter> chunk(num_threads + 1), split(num_threads);
+  std::vector<char> was_partitioned(num_threads);
+  for (int t = 0; t <= num_threads; ++t) chunk[t] = first + n * t / num_threads;
+  auto less_pivot = [&](const T& x) { return comp(x, pivot); };
+  run_team(num_threads, [&](int t) {
+    was_partitioned[t] = std::is_partitioned(chunk[t], chunk[t + 1], less_pivot);
+    split[t] = was_partitioned[t] ? std::partition_point(chunk[t], chunk[t + 1], less_pivot)
+                                  : lomuto_partition(chunk[t], chunk[t + 1], pivot, comp);
+  });
+
+  // 2. Intervals of elements on the wrong side of the global split point.
+  diff_t num_less = 0;
+  for (int t = 0; t < num_threads; ++t) num_less += split[t] - chunk[t];
+  const Iter mid = first + num_less;
+  std::vector<std::pair<Iter, Iter>> wrong_l, wrong_r;
+  for (int t = 0; t < num_threads; ++t) {
+    Iter a = split[t], b = std::min(chunk[t + 1], mid);
+    if (a < b) wrong_l.push_back(std::make_pair(a, b));   // not less, left of mid
+    a = std::max(chunk[t], mid); b = split[t];
+    if (a < b) wrong_r.push_back(std::make_pair(a, b));   // less, right of mid
+  }
+  std::vector<diff_t> cum_l(1, 0), cum_r(1, 0);
+  for (auto& w : wrong_l) cum_l.push_back(cum_l.back() + (w.second - w.first));
+  for (auto& w : wrong_r) cum_r.push_back(cum_r.back() + (w.second - w.first));
+  const diff_t num_wrong = cum_l.back();  // == cum_r.back()
+
+  // 3. Swap the k-th wrong element on the left with the k-th wrong element on the right.
+  if (num_wrong > 0) {
+    auto locate = [](const std::vector<std::pair<Iter, Iter>>& w, const std::vector<diff_t>& cum,
+                     diff_t k) -> std::pair<size_t, Iter> {
+      size_t i = std::upper_bound(cum.begin(), cum.end(), k) - cum.begin() - 1;
+      return std::make_pair(i, w[i].first + (k - cum[i]));
+    };
+    int swap_threads = (int) std::max<diff_t>(1, std::min<diff_t>(num_threads,
+                                                                  num_wrong / block_size));
+    run_team(swap_threads, [&](int t) {
+      diff_t k = num_wrong * t / swap_threads, k_end = num_wrong * (t + 1) / swap_threads;
+      if (k >= k_end) return;
+      std::pair<size_t, Iter> l = locate(wrong_l, cum_l, k), r = locate(wrong_r, cum_r, k);
+      while (k < k_end) {
+        diff_t step = std::min(std::min(wrong_l[l.first].second - l.second,
+                                        wrong_r[r.first].second - r.second), k_end - k);
+        std::swap_ranges(l.second, l.second + step, r.second);
+        k += step;
+        l.second += step;
+        r.second += step;
+        if (l.second == wrong_l[l.first].second && ++l.first < wrong_l.size())
+          l.second = wrong_l[l.first].first;
+        if (r.second == wrong_r[r.first].second && ++r.first < wrong_r.size())
+          r.second = wrong_r[r.first].first;
+      }
+    });
+  }
+
+  bool already_partitioned = num_wrong == 0;
+  for (int t = 0; t < num_threads; ++t) already_partitioned &= was_partitioned[t] != 0;
+
+  // Put the pivot in the right place.
+  Iter pivot_pos = mid - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = pivot;
+
+  return std::make_pair(pivot_pos, already_partitioned);
+}
+
+// Work-stealing pool sorting the subranges.
+template<class Iter, class Compare, bool Branchless>
+class pool {
+public:
+  pool(int num_threads, Compare comp)
+    : comp(comp), queues(num_threads), locks(num_threads), pending(0) {}
+
+  void push(int worker, const task<Iter>& t) {
+    ++pending;
+    std::lock_guard<std::mutex> guard(locks[worker]);
+    queues[worker].push_back(t);
+  }
+
+  void run() {
+    run_team((int) queues.size(), [this](int t) { work(t); });
+  }
+
+private:
+  Compare comp;
+  std::vector<std::deque<task<Iter>>> queues;
+  std::vector<std::mutex> locks;
+  std::atomic<size_t> pending;
+
+  bool pop(int worker, task<Iter>& t) {
+    std::lock_guard<std::mutex> guard(locks[worker]);
+    if (queues[worker].empty()) return false;
+    t = queues[worker].back();
+    queues[worker].pop_back();
+    return true;
+  }
+
+  bool steal(int thief, task<Iter>& t) {
+    const int num_workers = (int) queues.size();
+    for (int i = 1; i < num_workers; ++i) {
+      int victim = (thief + i) % num_workers;
+      std::lock_guard<std::mutex> guard(locks[victim]);
+      if (!queues[victim].empty()) {
+        t = queues[victim].front();
+        queues[victim].pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(int worker) {
+    task<Iter> t;
+    while (pending > 0) {
+      if (pop(worker, t) || steal(worker, t)) {
+        sort(worker, t);
+        --pending;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // pdqsort_loop that hands the left partitions of large subranges to the pool.
+  void sort(int worker, task<Iter> t) {
+    typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+    Iter begin = t.begin, end = t.end;
+    int bad_allowed = t.bad_allowed;
+    bool leftmost = t.leftmost;
+
+    while (true) {
+      diff_t size = end - begin;
+      if (size < parallel_split_threshold) {
+        if (size > 0)
+          pdqsort_loop<Iter, Compare, Branchless>(begin, end, comp, bad_allowed, leftmost);
+        return;
+      }
+
+      choose_pivot(begin, end, comp);
+
+      if (!leftmost && !comp(*(begin - 1), *begin)) {
+        begin = partition_left(begin, end, comp) + 1;
+        continue;
+      }
+
+      std::pair<Iter, bool> part_result =
+        Branchless ? partition_right_simd(begin, end, comp, is_simd_sortable<Iter, Compare>())
+          : partition_right(begin, end, comp);
+      Iter pivot_pos = part_result.first;
+
+      if (after_partition(begin, end, pivot_pos, part_result.second, comp, bad_allowed))
+        return;
+
+      task<Iter> left = { begin, pivot_pos, bad_allowed, leftmost };
+      push(worker, left);
+      begin = pivot_pos + 1;
+      leftmost = false;
+    }
+  }
+};
+
+template<class Iter, class Compare, bool Branchless>
+inline void pdqsort_parallel(Iter begin, Iter end, Compare comp, int num_threads) {
+  typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+  const diff_t n = end - begin;
+
+  if (num_threads <= 1 || n < parallel_threshold) {
+    pdqsort_loop<Iter, Compare, Branchless>(begin, end, comp, log2(n));
+    return;
+  }
+
+  // 1. Partition the top levels with teams of threads proportional to the subrange size.
+  const diff_t team_threshold = std::max<diff_t>(parallel_threshold, n / num_threads);
+  std::vector<task<Iter>> top(1, task<Iter>{ begin, end, log2(n), true });
+  std::vector<task<Iter>> rest;
+  while (!top.empty()) {
+    task<Iter> t = top.back();
+    top.pop_back();
+    diff_t size = t.end - t.begin;
+    if (size <= team_threshold) {
+      rest.push_back(t);
+      continue;
+    }
+
+    choose_pivot(t.begin, t.end, comp);
+
+    if (!t.leftmost && !comp(*(t.begin - 1), *t.begin)) {
+      t.begin = partition_left(t.begin, t.end, comp) + 1;
+      top.push_back(t);
+      continue;
+    }
+
+    int team = (int) std::max<diff_t>(1, std::min<diff_t>(num_threads,
+                                                          (num_threads * size + n - 1) / n));
+    std::pair<Iter, bool> part_result = partition_right_parallel(t.begin, t.end, comp, team);
+    Iter pivot_pos = part_result.first;
+
+    if (after_partition(t.begin, t.end, pivot_pos, part_result.second, comp, t.bad_allowed))
+      continue;
+
+    top.push_back(task<Iter>{ t.begin, pivot_pos, t.bad_allowed, t.leftmost });
+    top.push_back(task<Iter>{ pivot_pos + 1, t.end, t.bad_allowed, false });
+  }
+
+  // 2. Sort the subranges with the work-stealing pool, largest first.
+  std::sort(rest.begin(), rest.end(), [](const task<Iter>& a, const task<Iter>& b) {
+    return a.end - a.begin > b.end - b.begin;
+  });
+  pool<Iter, Compare, Branchless> workers(num_threads, comp);
+  for (size_t i = 0; i < rest.size(); ++i) workers.push(i % num_threads, rest[i]);
+  workers.run();
+}
+}
+}
+
+
+// Sorts [begin, end) with num_threads threads (num_threads <= 0 uses all hardware threads).
+template<class Iter, class Compare>
+inline void pdqsort_parallel(Iter begin, Iter end, Compare comp, int num_threads = 0) {
+  if (begin == end) return;
+  if (num_threads <= 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+  pdqsort_detail::parallel::pdqsort_parallel<Iter, Compare, false>(begin, end, comp, num_threads);
+}
+
+template<class Iter, class Compare>
+inline void pdqsort_parallel_branchless(Iter begin, Iter end, Compare comp, int num_threads = 0) {
+  if (begin == end) return;
+  if (num_threads <= 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+  pdqsort_detail::parallel::pdqsort_parallel<Iter, Compare, true>(begin, end, comp, num_threads);
+}
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ pdqsort_simd.h - Vectorized kernels for pdqsort_branchless on numeric keys.
+
+ 1. partition<Desc>(first, last, pivot) moves the keys less than pivot (greater than pivot if
+    Desc, for std::greater) to the front of [first, last) and returns the split point. On x86 it processes a vector of keys at a time: AVX-512 writes
+    both sides with compress-stores (vcompresspd, vpcompressq, vpcompressd), AVX2 permutes the
+    vector with a lookup table so that the keys less than pivot come first and stores it to both
+    sides. The kernel is chosen once at runtime with __builtin_cpu_supports, other CPUs use a
+    branchless scalar loop. Supported keys are double, int64_t and int32_t.
+
+    The partition is in place: the first and last vector are saved, then the next vector is
+    always read from the side with less free space, which guarantees room for a full vector on
+    both sides of the write cursors. The remaining keys and the two saved vectors are placed at
+    the end.
+
+ 2. network_sort<Desc>(a, n) sorts n <= network_threshold keys with Batcher's odd-even merge sort
+    network of network_threshold wires restricted to the first n wires (the dropped comparators
+    would only compare with virtual +inf keys). Compare-exchanges are branchless and never
+    duplicate or lose keys, also not with NaN.
+
+ Used by pdqsort.h, see partition_right_simd and pdqsort_loop there.
+ */
+
+#ifndef PDQSORT_SIMD_H
+#define PDQSORT_SIMD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PDQSORT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace pdqsort_simd {
+enum {
+  // Subarrays up to this size are sorted with the sorting network.
+  network_threshold = 16
+};
+
+// Keys and comparators with a vectorized partition.
+template<class T> struct is_simd_key : std::false_type { };
+template<> struct is_simd_key<double> : std::true_type { };
+template<> struct is_simd_key<std::int64_t> : std::true_type { };
+template<> struct is_simd_key<std::int32_t> : std::true_type { };
+
+template<class Iter, class Compare> struct is_simd_sortable : std::false_type { };
+template<class T> struct is_simd_sortable<T*, std::less<T>> : is_simd_key<T> { };
+template<class T> struct is_simd_sortable<T*, std::less<>> : is_simd_key<T> { };
+template<class T> struct is_simd_sortable<T*, std::greater<T>> : is_simd_key<T> { };
+template<class T> struct is_simd_sortable<T*, std::greater<>> : is_simd_key<T> { };
+
+// Descending order: the kernels put the keys greater than the pivot first.
+template<class Compare> struct is_descending : std::false_type { };
+template<class T> struct is_descending<std::greater<T>> : std::true_type { };
+template<> struct is_descending<std::greater<>> : std::true_type { };
+
+// True if the key x belongs before pivot.
+template<bool Desc, class T>
+inline bool before(T x, T pivot) {
+  return Desc ? pivot < x : x < pivot;
+}
+
+// Branchless scalar partition (used for small ranges and on CPUs without AVX2).
+template<bool Desc, class T>
+inline T* partition_scalar(T* first, T* last, T pivot) {
+  T* lt = first;
+  for (T* it = first; it != last; ++it) {
+    T x = *it;
+    bool c = before<Desc>(x, pivot);
+    *it = *lt;
+    *lt = x;
+    lt += c;
+  }
+  return lt;
+}
+
+// Places the keys of tmp[0, n) at the write cursors, no vector room is needed.
+template<bool Desc, class T>
+inline void place_scalar(const T* tmp, size_t n, T pivot, T*& wl, T*& wr) {
+  for (size_t i = 0; i < n; ++i) {
+    T x = tmp[i];
+    bool c = before<Desc>(x, pivot);
+    T* dst = c ? wl : wr - 1;
+    *dst = x;
+    wl += c;
+    wr -= !c;
+  }
+}
+
+#ifdef PDQSORT_SIMD_X86
+
+// Lookup tables of _mm256_permutevar8x32 indices moving the lanes set in the mask to the front
+// (followed by the other lanes), for 4 lanes of 64 bits and 8 lanes of 32 bits.
+inline const std::int32_t* permute_lut(int lanes) {
+  static const std::vector<std::int32_t> lut4 = [] {
+    std::vector<std::int32_t> lut(16 * 8);
+    for (int m = 0; m < 16; ++m) {
+      int k = 0;
+      for (int pass = 0; pass < 2; ++pass)
+        for (int i = 0; i < 4; ++i)
+          if (((m >> i) & 1) == (pass == 0)) {
+            lut[m * 8 + 2 * k] = 2 * i;
+            lut[m * 8 + 2 * k + 1] = 2 * i + 1;
+            ++k;
+          }
+    }
+    return lut;
+  }();
+  static const std::vector<std::int32_t> lut8 = [] {
+    std::vector<std::int32_t> lut(256 * 8);
+    for (int m = 0; m < 256; ++m) {
+      int k = 0;
+      for (int pass = 0; pass < 2; ++pass)
+        for (int i = 0; i < 8; ++i)
+          if (((m >> i) & 1) == (pass == 0)) lut[m * 8 + k++] = i;
+    }
+    return lut;
+  }();
+  return lanes == 4 ? lut4.data() : lut8.data();
+}
+
+template<class T> struct avx2;
+
+template<> struct avx2<double> {
+  typedef __m256d vec;
+  enum { lanes = 4 };
+  __attribute__((target("avx2"))) static vec set1(double x) { return _mm256_set1_pd(x); }
+  __attribute__((target("avx2"))) static vec load(const double* p) { return _mm256_loadu_pd(p); }
+  __attribute__((target("avx2"))) static void store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+  __attribute__((target("avx2"))) static int lt_mask(vec v, vec pivot) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(v, pivot, _CMP_LT_OQ));
+  }
+  __attribute__((target("avx2"))) static vec permute(vec v, const std::int32_t* idx) {
+    __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx));
+    return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), i));
+  }
+};
+
+template<> struct avx2<std::int64_t> {
+  typedef __m256i vec;
+  enum { lanes = 4 };
+  __attribute__((target("avx2"))) static vec set1(std::int64_t x) {
+    return _mm256_set1_epi64x(x);
+  }
+  __attribute__((target("avx2"))) static vec load(const std::int64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2"))) static void store(std::int64_t* p, vec v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  __attribute__((target("avx2"))) static int lt_mask(vec v, vec pivot) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(pivot, v)));
+  }
+  __attribute__((target("avx2"))) static vec permute(vec v, const std::int32_t* idx) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)));
+  }
+};
+
+template<> struct avx2<std::int32_t> {
+  typedef __m256i vec;
+  enum { lanes = 8 };
+  __attribute__((target("avx2"))) static vec set1(std::int32_t x) { return _mm256_set1_epi32(x); }
+  __attribute__((target("avx2"))) static vec load(const std::int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  __attribute__((target("avx2"))) static void store(std::int32_t* p, vec v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  __attribute__((target("avx2"))) static int lt_mask(vec v, vec pivot) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, v)));
+  }
+  __attribute__((target("avx2"))) static vec permute(vec v, const std::int32_t* idx) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)));
+  }
+};
+
+template<bool Desc, class T>
+__attribute__((target("avx2,popcnt"))) inline T* partition_avx2(T* first, T* last, T pivot) {
+  typedef avx2<T> K;
+  typedef typename K::vec vec;
+  const std::ptrdiff_t L = K::lanes;
+  if (last - first < 2 * L) return partition_scalar<Desc>(first, last, pivot);
+
+  const std::int32_t* lut = permute_lut(L);
+  const vec p = K::set1(pivot);
+  const vec v_first = K::load(first), v_last = K::load(last - L);
+  T* wl = first;
+  T* wr = last;
+  T* rl = first + L;
+  T* rr = last - L;
+  while (rr - rl >= L) {
+    vec v;
+    if (rl - wl <= wr - rr) {
+      v = K::load(rl);
+      rl += L;
+    } else {
+      rr -= L;
+      v = K::load(rr);
+    }
+    int m = Desc ? K::lt_mask(p, v) : K::lt_mask(v, p);
+    int n = __builtin_popcount(m);
+    vec pv = K::permute(v, lut + m * 8);
+    K::store(wl, pv);
+    K::store(wr - L, pv);
+    wl += n;
+    wr -= L - n;
+  }
+
+  T tmp[3 * L];
+  size_t rest = rr - rl;
+  std::copy(rl, rr, tmp);
+  K::store(tmp + rest, v_first);
+  K::store(tmp + rest + L, v_last);
+  place_scalar<Desc>(tmp, rest + 2 * L, pivot, wl, wr);
+  return wl;
+}
+
+template<class T> struct avx512;
+
+template<> struct avx512<double> {
+  typedef __m512d vec;
+  enum { lanes = 8 };
+  __attribute__((target("avx512f"))) static vec set1(double x) { return _mm512_set1_pd(x); }
+  __attribute__((target("avx512f"))) static vec load(const double* p) { return _mm512_loadu_pd(p); }
+  __attribute__((target("avx512f"))) static void store(double* p, vec v) { _mm512_storeu_pd(p, v); }
+  __attribute__((target("avx512f"))) static unsigned lt_mask(vec v, vec pivot) {
+    return _mm512_cmp_pd_mask(v, pivot, _CMP_LT_OQ);
+  }
+  __attribute__((target("avx512f"))) static void compress(double* p, unsigned m, vec v) {
+    _mm512_mask_compressstoreu_pd(p, (__mmask8) m, v);
+  }
+};
+
+template<> struct avx512<std::int64_t> {
+  typedef __m512i vec;
+  enum { lanes = 8 };
+  __attribute__((target("avx512f"))) static vec set1(std::int64_t x) { return _mm512_set1_epi64(x); }
+  __attribute__((target("avx512f"))) static vec load(const std::int64_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  __attribute__((target("avx512f"))) static void store(std::int64_t* p, vec v) {
+    _mm512_storeu_si512(p, v);
+  }
+  __attribute__((target("avx512f"))) static unsigned lt_mask(vec v, vec pivot) {
+    return _mm512_cmplt_epi64_mask(v, pivot);
+  }
+  __attribute__((target("avx512f"))) static void compress(std::int64_t* p, unsigned m, vec v) {
+    _mm512_mask_compressstoreu_epi64(p, (__mmask8) m, v);
+  }
+};
+
+template<> struct avx512<std::int32_t> {
+  typedef __m512i vec;
+  enum { lanes = 16 };
+  __attribute__((target("avx512f"))) static vec set1(std::int32_t x) { return _mm512_set1_epi32(x); }
+  __attribute__((target("avx512f"))) static vec load(const std::int32_t* p) {
+    return _mm512_loadu_si512(p);
+  }
+  __attribute__((target("avx512f"))) static void store(std::int32_t* p, vec v) {
+    _mm512_storeu_si512(p, v);
+  }
+  __attribute__((target("avx512f"))) static unsigned lt_mask(vec v, vec pivot) {
+    return _mm512_cmplt_epi32_mask(v, pivot);
+  }
+  __attribute__((target("avx512f"))) static void compress(std::int32_t* p, unsigned m, vec v) {
+    _mm512_mask_compressstoreu_epi32(p, (__mmask16) m, v);
+  }
+};
+
+template<bool Desc, class T>
+__attribute__((target("avx512f,popcnt"))) inline T* partition_avx512(T* first, T* last, T pivot) {
+  typedef avx512<T> K;
+  typedef typename K::vec vec;
+  const std::ptrdiff_t L = K::lanes;
+  const unsigned all = (1u << L) - 1;
+  if (last - first < 2 * L) return partition_scalar<Desc>(first, last, pivot);
+
+  const vec p = K::set1(pivot);
+  const vec v_first = K::load(first), v_last = K::load(last - L);
+  T* wl = first;
+  T* wr = last;
+  T* rl = first + L;
+  T* rr = last - L;
+  while (rr - rl >= L) {
+    vec v;
+    if (rl - wl <= wr - rr) {
+      v = K::load(rl);
+      rl += L;
+    } else {
+      rr -= L;
+      v = K::load(rr);
+    }
+    unsigned m = Desc ? K::lt_mask(p, v) : K::lt_mask(v, p);
+    int n = __builtin_popcount(m);
+    K::compress(wl, m, v);
+    wl += n;
+    wr -= L - n;
+    K::compress(wr, ~m & all, v);
+  }
+
+  T tmp[3 * L];
+  size_t rest = rr - rl;
+  std::copy(rl, rr, tmp);
+  K::store(tmp + rest, v_first);
+  K::store(tmp + rest + L, v_last);
+  place_scalar<Desc>(tmp, rest + 2 * L, pivot, wl, wr);
+  return wl;
+}
+
+#endif  // PDQSORT_SIMD_X86
+
+template<bool Desc, class T>
+struct partition_kernel {
+  typedef T* (*fn)(T*, T*, T);
+
+  // Picks the widest kernel the CPU supports (once), 0 if there is none.
+  static fn get() {
+    static const fn kernel = []() -> fn {
+#ifdef PDQSORT_SIMD_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) return partition_avx512<Desc, T>;
+      if (__builtin_cpu_supports("avx2")) return partition_avx2<Desc, T>;
+#endif
+      return 0;
+    }();
+    return kernel;
+  }
+};
+
+// Returns true if a vectorized partition is available for T on this CPU.
+template<class T>
+inline bool has_partition() {
+  return partition_kernel<false, T>::get() != 0;
+}
+
+// Moves the keys less (greater if Desc) than pivot to the front of [first, last), returns the
+// split point.
+template<bool Desc, class T>
+inline T* partition(T* first, T* last, T pivot) {
+  typename partition_kernel<Desc, T>::fn kernel = partition_kernel<Desc, T>::get();
+  return kernel ? kernel(first, last, pivot) : partition_scalar<Desc>(first, last, pivot);
+}
+
+// Odd-even merge sort network of network_threshold wires restricted to the first N wires.
+struct comparator { unsigned char a, b; };
+
+template<size_t N>
+struct network {
+  template<class F>
+  static constexpr void generate(F emit) {
+    const size_t W = network_threshold;
+    for (size_t p = 1; p < W; p <<= 1)
+      for (size_t k = p; k >= 1; k >>= 1)
+        for (size_t j = k % p; j + k < W; j += 2 * k)
+          for (size_t i = 0; i < std::min(k, W - j - k); ++i)
+            if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < N) emit(i + j, i + j + k);
+  }
+
+  struct counter {
+    size_t* n;
+    constexpr void operator()(size_t, size_t) const { ++*n; }
+  };
+
+  static constexpr size_t count() {
+    size_t n = 0;
+    generate(counter{&n});
+    return n;
+  }
+
+  struct filler {
+    comparator* c;
+    size_t* n;
+    constexpr void operator()(size_t a, size_t b) const {
+      c[*n].a = (unsigned char) a;
+      c[*n].b = (unsigned char) b;
+      ++*n;
+    }
+  };
+
+  struct table { comparator c[count() + 1]; };
+
+  static constexpr table comparators() {
+    table t{};
+    size_t n = 0;
+    generate(filler{t.c, &n});
+    return t;
+  }
+};
+
+template<bool Desc, class T>
+inline void compare_exchange(T& x, T& y) {
+  bool swap = before<Desc>(y, x);
+  T lo = swap ? y : x;
+  T hi = swap ? x : y;
+  x = lo;
+  y = hi;
+}
+
+// Sorts a[0, N) in registers with the fully unrolled network.
+template<bool Desc, class T, size_t N, size_t... I>
+inline void network_sort_n(T* a, std::index_sequence<I...>) {
+  constexpr typename network<N>::table net = network<N>::comparators();
+  (void) net;
+  T v[N];
+  for (size_t i = 0; i < N; ++i) v[i] = a[i];
+  (void) std::initializer_list<int>{ (compare_exchange<Desc>(v[net.c[I].a], v[net.c[I].b]), 0)... };
+  for (size_t i = 0; i < N; ++i) a[i] = v[i];
+}
+
+template<bool Desc, class T, size_t N>
+inline void network_sort_n(T* a) {
+  network_sort_n<Desc, T, N>(a, std::make_index_sequence<network<N>::count()>());
+}
+
+template<bool Desc, class T, size_t... N>
+inline void network_sort_switch(T* a, size_t n, std::index_sequence<N...>) {
+  typedef void (*fn)(T*);
+  static const fn sorters[] = { network_sort_n<Desc, T, N>... };
+  sorters[n](a);
+}
+
+// Sorts a[0, n) for n <= network_threshold (descending if Desc).
+template<bool Desc, class T>
+inline void network_sort(T* a, size_t n) {
+  network_sort_switch<Desc>(a, n, std::make_index_sequence<network_threshold + 1>());
+}
+}
+
+#endif
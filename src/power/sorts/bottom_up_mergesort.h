@@ -4,6 +4,7 @@
 #define MERGESORTS_BOTTOM_UP_MERGESORT_H
 
 #include "../algorithms.h"
+#include "../../buffer_cache.h"
 #include "insertionsort.h"
 #include "merging.h"
 
@@ -24,7 +25,7 @@ namespace peekpower {
 	private:
 		using typename sorter<Iterator>::elem_t;
 		using typename sorter<Iterator>::diff_t;
-		std::vector<elem_t> _buffer;
+		greensort_buffer<elem_t> _buffer;
 	public:
 
 		void sort(Iterator begin, Iterator end) override {
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include "../algorithms.h"
+#include "../../buffer_cache.h"
 #include "insertionsort.h"
 #include "merging.h"
 #include <vector>
@@ -31,7 +32,7 @@ namespace peekpower {
 	private:
 		using typename sorter<Iterator>::elem_t;
 		using typename sorter<Iterator>::diff_t;
-		std::vector<elem_t> _buffer;
+		greensort_buffer<elem_t> _buffer;
 #ifdef DEBUG_SORTING
 		Iterator globalBegin, globalEnd;
 #endif
@@ -5,6 +5,7 @@
 
 #include <cassert>
 #include "../algorithms.h"
+#include "../../buffer_cache.h"
 #include "insertionsort.h"
 #include "merging.h"
 #include <vector>
@@ -163,7 +164,7 @@ namespace peekpower {
 	private:
 		using typename sorter<Iterator>::elem_t;
 		using typename sorter<Iterator>::diff_t;
-		std::vector<elem_t> _buffer;
+		greensort_buffer<elem_t> _buffer;
 		Iterator globalBegin, globalEnd;
 
         struct run {
@@ -7,6 +7,7 @@
 #include <cassert>
 #include <cmath>
 #include "../algorithms.h"
+#include "../../buffer_cache.h"
 #include "insertionsort.h"
 #include "merging.h"
 #include "merging_3way.h"
@@ -145,7 +146,7 @@ namespace peekpower {
     private:
         using typename sorter<Iterator>::elem_t;
         using typename sorter<Iterator>::diff_t;
-        std::vector<elem_t> _buffer;
+        greensort_buffer<elem_t> _buffer;
         Iterator globalBegin, globalEnd;
 
         struct run_begin_n_power{
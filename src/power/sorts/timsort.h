@@ -40,6 +40,8 @@
 #include <cassert>
 #include <algorithm> // std::copy
 #include <functional> // std::less
+#include <type_traits> // std::conditional
+#include "../../buffer_cache.h"
 
 #ifdef ENABLE_TIMSORT_LOG
 #include <iostream>
@@ -149,8 +151,11 @@ template <typename RandomAccessIterator, typename LessFunction> class TimSort {
 
     int minGallop_; // default to MIN_GALLOP
 
-    std::vector<value_t> tmp_; // temp storage for merges
-    typedef typename std::vector<value_t>::iterator tmp_iter_t;
+    // temp storage for merges, from the package buffer cache for trivially copyable values
+    typedef typename std::conditional<std::is_trivially_copyable<value_t>::value,
+                                      greensort_buffer<value_t>, std::vector<value_t> >::type tmp_t;
+    tmp_t tmp_;
+    typedef typename tmp_t::iterator tmp_iter_t;
 
     struct run {
         iter_t base;
@@ -664,6 +669,15 @@ template <typename RandomAccessIterator, typename LessFunction> class TimSort {
     void copy_to_tmp(iter_t const begin, diff_t const len) {
         tmp_.clear();
         tmp_.reserve(len);
+        copy_to_tmp(begin, len, std::is_trivially_copyable<value_t>());
+    }
+
+    void copy_to_tmp(iter_t const begin, diff_t const len, std::true_type) {
+        tmp_.resize(len);
+        std::copy(begin, begin + len, tmp_.begin());
+    }
+
+    void copy_to_tmp(iter_t const begin, diff_t const len, std::false_type) {
         GFX_TIMSORT_MOVE_RANGE(begin, begin + len, std::back_inserter(tmp_));
     }
 
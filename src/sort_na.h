@@ -0,0 +1,112 @@
+/*
+# greeNsort Header-Code for putting NA first or last before sorting
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+#*/
+
+/*
+ The comparison engines compare with std::less<>, which is no strict weak ordering if there are
+ NaN (NA_real_ is a NaN): pdqsort and IPS4o may then return unsorted data or run out of the
+ range. And NA_integer_ (also NA of logical and factor) is INT_MIN, NA of integer64 is
+ INT64_MIN, hence they would sort first. GreensortNaSplit moves the NA of each type to the end
+ (na_last) or the front in one pass and returns the span of the other values, which the engine
+ sorts with the plain comparator. -0 and +0 compare equal with std::less<>, like in R.
+
+ The scan counting the NA is branch-free and vectorized by the compiler, without NA (the common
+ case) nothing is moved. Otherwise the values are compacted and the NA are put behind (or before)
+ them in their original order, such that NA_real_ and NaN keep their order like in R.
+
+ The radix engines do not need the pass: GreensortRadixKey maps NA to the smallest or largest
+ key and -0 to the key of +0, and complements the keys of the values for decreasing order.
+*/
+
+#ifndef ALREADY_DEFINED_sort_na_h
+#define ALREADY_DEFINED_sort_na_h
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "buffer_cache.h"
+#include "sort_types.h"
+
+inline bool GreensortIsNA(double x) { return x != x; }
+inline bool GreensortIsNA(int x) { return x == NA_INTEGER; }
+inline bool GreensortIsNA(std::int64_t x) { return x == INT64_MIN; }
+
+// Number of NA in x[0..n)
+template<class T>
+size_t GreensortNaCount(const T* x, size_t n) {
+  size_t i, c = 0;
+  for (i=0;i<n;i++)
+    c += GreensortIsNA(x[i]);
+  return c;
+}
+
+// Moves the NA of x to the end (na_last) or to the front, returns the span of the other values
+template<class T>
+greensort_span<T> GreensortNaSplit(greensort_span<T> x, bool na_last) {
+  size_t i, j, k, n = x.size();
+  size_t c = GreensortNaCount(x.begin(), n);
+  if (!c)
+    return x;
+  greensort_buffer<T> na;
+  na.resize(c);
+  if (na_last){
+    for (i=0,j=0,k=0;i<n;i++){
+      T v = x[i];
+      if (GreensortIsNA(v))
+        na[k++] = v;
+      else
+        x[j++] = v;
+    }
+    std::copy(na.begin(), na.end(), x.begin() + j);
+    return greensort_span<T>(x.begin(), n - c, x.type());
+  }
+  for (i=n,j=n,k=c;i>0;i--){
+    T v = x[i-1];
+    if (GreensortIsNA(v))
+      na[--k] = v;
+    else
+      x[--j] = v;
+  }
+  std::copy(na.begin(), na.end(), x.begin());
+  return greensort_span<T>(x.begin() + c, n - c, x.type());
+}
+
+// Unsigned radix key of the order of the values with NA last (or first), -0 is a tie with +0.
+// Decreasing order complements the key of the values, hence the radix engines need no reversal
+// pass and stay stable.
+struct GreensortRadixKey {
+  bool na_last;
+  bool decreasing;
+  explicit GreensortRadixKey(bool na_last, bool decreasing = false) : na_last(na_last), decreasing(decreasing) {}
+  std::uint64_t operator()(double x) const {
+    if (x != x)
+      return na_last ? UINT64_MAX : 0;
+    x += 0.0;
+    std::uint64_t u;
+    std::memcpy(&u, &x, sizeof(u));
+    // IEEE-754: flip all bits of negatives, only the sign bit of positives
+    u ^= ((std::uint64_t) ((std::int64_t) u >> 63) | UINT64_C(0x8000000000000000));
+    // the NaN keys 0 and UINT64_MAX are no value keys in either direction
+    return decreasing ? ~u : u;
+  }
+  // NA is the minimum with key 0: ascending it becomes the maximum by subtracting 1, decreasing
+  // the complement makes it the maximum, adding 1 the minimum
+  std::uint32_t operator()(int x) const {
+    std::uint32_t u = (std::uint32_t) x ^ UINT32_C(0x80000000);
+    if (decreasing)
+      return na_last ? ~u : ~u + 1;
+    return na_last ? u - 1 : u;
+  }
+  std::uint64_t operator()(std::int64_t x) const {
+    std::uint64_t u = (std::uint64_t) x ^ UINT64_C(0x8000000000000000);
+    if (decreasing)
+      return na_last ? ~u : ~u + 1;
+    return na_last ? u - 1 : u;
+  }
+};
+
+#endif
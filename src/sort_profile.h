@@ -0,0 +1,168 @@
+/*
+# greeNsort Header-Code for profiling the presortedness of the data
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+#*/
+
+/*
+ GreensortPresortedness estimates from two small samples the features that decide which engine
+ sorts the data cheapest:
+
+ runs, runlen  k blocks of 64 adjacent elements at evenly spaced positions are split into runs
+               like the natural merge sorts do (maximal non-decreasing or strictly decreasing),
+               the rate of run boundaries per adjacent pair extrapolates the number of runs
+ inversions    the fraction of inverted pairs among m pseudo-random pairs of m elements at evenly
+               spaced positions: 0 sorted, about 1/2 random, 1 reversed
+ duplicates    1 - distinct/m of that sample (hash table), near 1 for few distinct values
+ entropy       Shannon entropy of the sample in 64 equal-width bins over its range divided by 6
+               bits: 1 for uniform values, low for skewed values or outliers
+ na            the fraction of NA in the sample
+
+ Both samples have m elements, m is sample but at most n/64 (at least 64 or n). Profiling costs
+ O(m) without sorting the sample: an exact inversion count would need O(m log m) dependent
+ comparisons and cost more than all the rest. The features ignore NA which the engines put aside
+ before sorting.
+*/
+
+#ifndef ALREADY_DEFINED_sort_profile_h
+#define ALREADY_DEFINED_sort_profile_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "buffer_cache.h"
+#include "sort_na.h"
+
+struct GreensortProfile {
+  double n;
+  double na;
+  double runs;
+  double runlen;
+  double inversions;
+  double duplicates;
+  double entropy;
+};
+
+// Bits of a value for hashing, -0 and +0 hash alike
+inline std::uint64_t GreensortHashBits(double x) {
+  std::uint64_t u;
+  x += 0.0;
+  std::memcpy(&u, &x, sizeof(u));
+  return u;
+}
+inline std::uint64_t GreensortHashBits(int x) { return (std::uint32_t) x; }
+inline std::uint64_t GreensortHashBits(std::int64_t x) { return (std::uint64_t) x; }
+
+// Number of distinct values of a[0..n) counted in an open addressing hash table
+template<class T>
+size_t GreensortDistinct(const T* a, size_t n) {
+  int bits = 1;
+  while (((size_t) 1 << bits) < 2 * n)
+    bits++;
+  size_t i, h, mask = ((size_t) 1 << bits) - 1, d = 0;
+  greensort_buffer<T> key;
+  greensort_buffer<unsigned char> used;
+  key.resize(mask + 1);
+  used.resize(mask + 1);
+  std::memset(used.data(), 0, used.size());
+  for (i=0;i<n;i++){
+    h = (size_t) (GreensortHashBits(a[i]) * UINT64_C(0x9E3779B97F4A7C15) >> (64 - bits));
+    while (used[h] && !(key[h] == a[i]))
+      h = (h + 1) & mask;
+    if (!used[h]){
+      used[h] = 1;
+      key[h] = a[i];
+      d++;
+    }
+  }
+  return d;
+}
+
+template<class T>
+GreensortProfile GreensortPresortedness(const T* x, size_t n, size_t sample) {
+  const size_t L = 64, bins = 64;
+  GreensortProfile p = {(double) n, 0, n ? 1.0 : 0.0, (double) n, 0, 0, 0};
+  if (n < 2)
+    return p;
+  size_t m = std::min(sample, std::max(std::min(n, L), n / L));
+  m = std::max(std::min(m, n), (size_t) 2);
+  size_t i, j, l, c;
+
+  // run boundaries in k blocks of up to L adjacent elements
+  size_t len = std::min(L, n), k = std::max(m / len, (size_t) 1);
+  double bounds = 0, pairs = 0;
+  T v[L];
+  for (j=0;j<k;j++){
+    size_t s = k > 1 ? (size_t) ((double) (n - len) * j / (k - 1)) : 0;
+    for (l=0,i=s;i<s+len;i++)
+      if (!GreensortIsNA(x[i]))
+        v[l++] = x[i];
+    if (l < 2)
+      continue;
+    pairs += l - 1;
+    for (i=1;i<l;){
+      if (v[i] < v[i-1]){
+        while (++i < l && v[i] < v[i-1]);
+      }else{
+        while (++i < l && !(v[i] < v[i-1]));
+      }
+      if (i < l){
+        bounds++;
+        i++;
+      }
+    }
+  }
+
+  // strided sample for NA, inversions, duplicates and entropy
+  greensort_buffer<T> a;
+  a.resize(m);
+  for (l=0,c=0,i=0;i<m;i++){
+    T y = x[(size_t) ((double) n * i / m)];
+    if (GreensortIsNA(y))
+      c++;
+    else
+      a[l++] = y;
+  }
+  p.na = (double) c / m;
+  double nn = n * (1 - p.na);
+  if (pairs > 0 && nn > 1)
+    p.runs = 1 + bounds / pairs * (nn - 1);
+  p.runlen = n ? nn / p.runs : 0;
+  if (l < 2)
+    return p;
+  // inversions of m pseudo-random pairs of the sample (splitmix64)
+  std::uint64_t r = 0, inv = 0, npairs = 0;
+  for (i=0;i<m;i++){
+    std::uint64_t z = (r += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    z ^= z >> 31;
+    size_t u = (size_t) ((z & 0xFFFFFFFF) * l >> 32), w = (size_t) ((z >> 32) * l >> 32);
+    if (u == w)
+      continue;
+    npairs++;
+    inv += u < w ? a[w] < a[u] : a[u] < a[w];
+  }
+  p.inversions = npairs ? (double) inv / npairs : 0;
+  p.duplicates = 1 - (double) GreensortDistinct(a.data(), l) / l;
+  T lo = a[0], hi = a[0];
+  for (i=1;i<l;i++){
+    lo = a[i] < lo ? a[i] : lo;
+    hi = hi < a[i] ? a[i] : hi;
+  }
+  if (lo < hi && std::isfinite((double) hi - (double) lo)){
+    size_t h[bins] = {0};
+    for (i=0;i<l;i++)
+      h[std::min((size_t) (((double) a[i] - (double) lo) / ((double) hi - (double) lo) * bins), bins - 1)]++;
+    double e = 0;
+    for (i=0;i<bins;i++)
+      if (h[i])
+        e -= (double) h[i] / l * std::log2((double) h[i] / l);
+    p.entropy = e / std::log2((double) bins);
+  }
+  return p;
+}
+
+#endif
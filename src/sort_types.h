@@ -0,0 +1,78 @@
+/*
+# greeNsort Header-Code for dispatching the engines on the element type
+# (c) 2019 Dr. Jens Oehlschaegel
+# All rights reserved
+# Created: 2026-10-19
+#*/
+
+/*
+ The wrappers sort double, integer (also factor), logical and integer64 (bit64, int64 stored in a
+ double vector) without coercion: GreensortDispatch calls a generic lambda with a greensort_span
+ over the data of the R vector typed double, int or std::int64_t. The span has the interface of
+ NumericVector used by the wrappers (begin, end, size, []), the wrappers are templates over the
+ element type and report sizeof(T) as bytes per element.
+*/
+
+#ifndef ALREADY_DEFINED_sort_types_h
+#define ALREADY_DEFINED_sort_types_h
+
+#include <Rcpp.h>
+#include <algorithm>
+#include <cstdint>
+
+template<class T>
+class greensort_span {
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  greensort_span(T* data, R_xlen_t n, SEXPTYPE type) : data_(data), size_(n), type_(type) {}
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+  R_xlen_t size() const { return size_; }
+  T& operator[](R_xlen_t i) const { return data_[i]; }
+  // SEXPTYPE of the R vector, for returning values of the same type
+  SEXPTYPE type() const { return type_; }
+private:
+  T* data_;
+  R_xlen_t size_;
+  SEXPTYPE type_;
+};
+
+// integer64 of package bit64 is a double vector holding int64
+inline bool GreensortIsInteger64(SEXP x) {
+  return TYPEOF(x) == REALSXP && Rf_inherits(x, "integer64");
+}
+
+// Typed view of a double, integer or logical R vector (T must match its storage)
+template<class T>
+greensort_span<T> GreensortSpan(SEXP x) {
+  static_assert(sizeof(T) == sizeof(double) || sizeof(T) == sizeof(int), "T must be of the size of the R storage");
+  void* p = TYPEOF(x) == REALSXP ? (void*) REAL(x) : TYPEOF(x) == INTSXP ? (void*) INTEGER(x) : (void*) LOGICAL(x);
+  return greensort_span<T>(static_cast<T*>(p), Rf_xlength(x), TYPEOF(x));
+}
+
+// Calls f(greensort_span<T>) with T double, int (integer, logical, factor) or std::int64_t (integer64)
+template<class F>
+auto GreensortDispatch(SEXP x, F f) {
+  switch (TYPEOF(x)) {
+  case REALSXP:
+    if (GreensortIsInteger64(x))
+      return f(GreensortSpan<std::int64_t>(x));
+    return f(GreensortSpan<double>(x));
+  case INTSXP:
+  case LGLSXP:
+    return f(GreensortSpan<int>(x));
+  default:
+    Rcpp::stop("only double, integer, logical, factor and integer64 vectors implemented");
+  }
+}
+
+// A new R vector of the type of x holding v[0..m) (class and levels are restored in R)
+template<class T>
+Rcpp::RObject GreensortValues(const greensort_span<T>& x, const T* v, R_xlen_t m) {
+  Rcpp::RObject value(Rf_allocVector(x.type(), m));
+  std::copy(v, v + m, GreensortSpan<T>(value).begin());
+  return value;
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ strsort.h - Sorting of C strings in byte order (C collation)
+
+ mkqsort(a, n, str)
+   multikey quicksort (Bentley & Sedgewick 1997): three-way partitioning on the character at the
+   current depth, the part with characters equal to the pivot continues with the next character,
+   hence every character is inspected about once per partitioning level instead of every string
+   comparison rescanning the common prefix. Small parts are finished by insertion sort comparing
+   the suffixes from the current depth. Not stable (equal strings are interchangeable).
+   str(e) returns the NUL-terminated bytes of element e, characters compare as unsigned char.
+
+ (c) 2019 Dr. Jens Oehlschaegel
+ Created: 2026-10-19
+ */
+
+#ifndef STRSORT_H
+#define STRSORT_H
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+namespace strsort {
+
+namespace detail {
+
+const std::size_t insertion_sort_threshold = 16;
+
+inline int compare_from(const unsigned char* a, const unsigned char* b) {
+  while (*a && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return (int) *a - (int) *b;
+}
+
+template<class Elem, class Str>
+inline void insertion_sort(Elem* a, std::size_t n, std::size_t depth, Str str) {
+  for (std::size_t i = 1; i < n; ++i) {
+    Elem tmp = std::move(a[i]);
+    const unsigned char* s = str(tmp) + depth;
+    std::size_t j = i;
+    while (j > 0 && compare_from(s, str(a[j - 1]) + depth) < 0) {
+      a[j] = std::move(a[j - 1]);
+      --j;
+    }
+    a[j] = std::move(tmp);
+  }
+}
+
+inline int median3(int a, int b, int c) {
+  if (a < b) {
+    if (b < c) return b;
+    return a < c ? c : a;
+  }
+  if (a < c) return a;
+  return b < c ? c : b;
+}
+
+template<class Elem, class Str>
+void mkqsort_loop(Elem* a, std::size_t n, std::size_t depth, Str str) {
+  while (n > insertion_sort_threshold) {
+    int v = median3(str(a[0])[depth], str(a[n / 2])[depth], str(a[n - 1])[depth]);
+    // Dijkstra three-way partition: [0, lt) < v, [lt, i) == v, [gt, n) > v
+    std::size_t lt = 0, i = 0, gt = n;
+    while (i < gt) {
+      int c = str(a[i])[depth];
+      if (c < v)
+        std::swap(a[lt++], a[i++]);
+      else if (c > v)
+        std::swap(a[i], a[--gt]);
+      else
+        ++i;
+    }
+    mkqsort_loop(a, lt, depth, str);
+    mkqsort_loop(a + gt, n - gt, depth, str);
+    // the strings equal to the pivot have all ended: they are equal
+    if (v == 0)
+      return;
+    a += lt;
+    n = gt - lt;
+    ++depth;
+  }
+  insertion_sort(a, n, depth, str);
+}
+
+}
+
+template<class Elem, class Str>
+inline void mkqsort(Elem* a, std::size_t n, Str str) {
+  detail::mkqsort_loop(a, n, 0, str);
+}
+
+}
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef TIMSORT_COMPILER_H
-#define TIMSORT_COMPILER_H
+// No include guard: undef_compiler.h removes the macros at the end of each timsort header,
+// the next header (e.g. timsort_preallocated.h after timsort.h) defines them again.
 
 # ifndef TIMSORT_NO_USE_COMPILER_INTRINSICS
 
@@ -49,4 +49,3 @@
 
 # endif /* TIMSORT_NO_USE_COMPILER_INTRINSICS */
 
-#endif /* TIMSORT_COMPILER_H */
@@ -8,10 +8,12 @@
 #include <functional>
 #include <vector>
 #include <limits>
+#include <type_traits>
 #include "utils.h"
 #include "timsort_stack_buffer.h"
 #include "minrun.h"
 #include "compiler.h"
+#include "../buffer_cache.h"
 
 namespace tim {
 
@@ -38,10 +40,9 @@ struct TimSort
 		minrun(compute_minrun<value_type>(end_it - begin_it)),
 		min_gallop(default_min_gallop)
 	{
-		// try_get_cached_heap_buffer(heap_buffer);
+		// heap_buffer is drawn from and returned to the package buffer cache (buffer_cache.h)
 		fill_run_stack();
 		collapse_run_stack();
-		// try_cache_heap_buffer(heap_buffer);
 	}
 	
 	
@@ -517,8 +518,9 @@ struct TimSort
 	 * Empty stack space is used for merge buffer when possible.
 	 */
 	timsort_stack_buffer<std::size_t, value_type> stack_buffer; 
-	/** Fallback heap-allocated array used for merge buffer. */
-	std::vector<value_type> heap_buffer;
+	/** Fallback heap-allocated array used for merge buffer (from the package buffer cache). */
+	std::conditional_t<std::is_trivially_copyable_v<value_type>,
+		greensort_buffer<value_type>, std::vector<value_type>> heap_buffer;
 	/** 'begin' iterator to the range being sorted. */
 	const It start;
 	/** 'end' iterator to the range being sorted. */
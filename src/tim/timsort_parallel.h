@@ -0,0 +1,533 @@
+#ifndef TIMSORT_PARALLEL_H
+#define TIMSORT_PARALLEL_H
+
+/*
+ * Parallel stable timsort.
+ *
+ * The range is cut into one chunk per thread (at multiples of minrun).  The
+ * threads concurrently find the natural runs of their chunks, reversing
+ * strictly descending runs and extending short runs to minrun with binary
+ * insertion sort exactly like the sequential TimSort::push_next_run().  Runs
+ * that were cut by a chunk boundary are stitched back together if the two
+ * halves are in order.
+ *
+ * The merge pattern is the one of the sequential timsort: the run lengths are
+ * pushed through the same stack invariants (see TimSort::resolve_invariants()),
+ * but instead of merging immediately the merges are recorded as a merge tree.
+ * Subtrees with disjoint ranges are independent and are executed by different
+ * threads.  A merge with more than one thread is split by co-ranks (merge
+ * path) into equally large pieces that are merged concurrently, each piece
+ * with the galloping merge.
+ *
+ * The sort is stable.  Elements must be trivially copyable (the merge buffer of
+ * n elements is taken from the package buffer cache), other types and small
+ * ranges use the sequential tim::timsort().
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "timsort.h"
+#include "../buffer_cache.h"
+
+namespace tim {
+
+namespace internal {
+
+namespace parallel {
+
+/* Ranges smaller than this are sorted sequentially. */
+inline constexpr const std::size_t sequential_threshold = std::size_t(1) << 15;
+
+/* Merges smaller than this many elements per thread are not split. */
+inline constexpr const std::size_t merge_grain = std::size_t(1) << 14;
+
+/*
+ * @brief Runs fn(0), ..., fn(num_threads - 1) concurrently, fn(0) in the calling thread.
+ */
+template <class F>
+inline void run_team(std::size_t num_threads, F fn)
+{
+	std::vector<std::thread> team;
+	team.reserve(num_threads - 1);
+	for(std::size_t t = 1; t < num_threads; ++t)
+		team.emplace_back(fn, t);
+	fn(0);
+	for(auto& th : team)
+		th.join();
+}
+
+/*
+ * @brief Number of leading elements of [begin, end) satisfying pred, which
+ * must be true for a prefix of the range.  Gallops from the front.
+ */
+template <class It, class Pred>
+inline std::size_t gallop_count(It begin, It end, Pred pred)
+{
+	std::size_t len = end - begin;
+	std::size_t lo = 0, hi = 1;
+	while(hi < len and pred(begin[hi - 1]))
+	{
+		lo = hi;
+		hi = 2 * hi + 1;
+	}
+	if(hi > len)
+		hi = len;
+	return std::partition_point(begin + lo, begin + hi, pred) - begin;
+}
+
+/*
+ * @brief Galloping merge of [lbegin, lend) and [rbegin, rend) into dest.
+ *
+ * Takes from the right range only if it is strictly less, hence ties keep
+ * the left range first.  Called with reverse iterators and a reversed
+ * comparator this merges from the back while staying stable.  If
+ * RightInPlace the right range is the tail of the destination, then the
+ * remainder of the right range is not moved.
+ *
+ * requires:
+ *	[lbegin, lend) does not overlap with the destination range
+ *	dest never overtakes rbegin
+ */
+template <bool RightInPlace, class LeftIt, class RightIt, class DestIt, class Cmp>
+inline void gallop_merge_into(LeftIt lbegin, LeftIt lend, RightIt rbegin, RightIt rend,
+			      DestIt dest, Cmp cmp)
+{
+	std::size_t min_gallop = gallop_win_dist;
+	std::size_t lcount = 0, rcount = 0;
+	while(lbegin != lend and rbegin != rend)
+	{
+		if(cmp(*rbegin, *lbegin))
+		{
+			*dest = std::move(*rbegin);
+			++dest;
+			++rbegin;
+			lcount = 0;
+			if(++rcount >= min_gallop and rbegin != rend)
+			{
+				// gallop through the right range: all elements less than *lbegin
+				std::size_t k = gallop_count(rbegin, rend,
+					[&](const auto& x){ return cmp(x, *lbegin); });
+				dest = std::move(rbegin, rbegin + k, dest);
+				rbegin += k;
+				rcount = 0;
+				if(k >= gallop_win_dist)
+					min_gallop -= (min_gallop > 1);
+				else
+					++min_gallop;
+			}
+		}
+		else
+		{
+			*dest = std::move(*lbegin);
+			++dest;
+			++lbegin;
+			rcount = 0;
+			if(++lcount >= min_gallop and lbegin != lend)
+			{
+				// gallop through the left range: all elements not greater than *rbegin
+				std::size_t k = gallop_count(lbegin, lend,
+					[&](const auto& x){ return not cmp(*rbegin, x); });
+				dest = std::move(lbegin, lbegin + k, dest);
+				lbegin += k;
+				lcount = 0;
+				if(k >= gallop_win_dist)
+					min_gallop -= (min_gallop > 1);
+				else
+					++min_gallop;
+			}
+		}
+	}
+	dest = std::move(lbegin, lend, dest);
+	if constexpr(not RightInPlace)
+		std::move(rbegin, rend, dest);
+}
+
+/*
+ * A node of the merge tree.  Leaves are runs, inner nodes merge the adjacent
+ * ranges of their children: [begin, mid) and [mid, end).
+ */
+struct merge_node
+{
+	std::size_t begin;
+	std::size_t mid;
+	std::size_t end;
+	std::ptrdiff_t left;
+	std::ptrdiff_t right;
+};
+
+template <class It, class Comp>
+struct ParallelTimSort
+{
+	using value_type = iterator_value_type_t<It>;
+
+	ParallelTimSort(It begin_it, It end_it, Comp comp_func, std::size_t num_threads):
+		start(begin_it),
+		comp(comp_func),
+		n(end_it - begin_it),
+		threads(num_threads),
+		minrun(compute_minrun<value_type>(end_it - begin_it))
+	{
+		buffer.resize(n);
+		find_runs();
+		build_merge_tree();
+		if(not nodes.empty())
+			execute(nodes.size() - 1, threads, 0);
+	}
+
+	/*
+	 * @brief Finds the runs of the chunks concurrently and stitches runs cut by
+	 * chunk boundaries.  Afterwards 'runs' holds the end offsets of all runs.
+	 *
+	 * Two runs meeting at a chunk boundary are joined if they are in order.  If
+	 * they are in reverse order (a descending run cut by the boundaries and
+	 * reversed piecewise) the chain of such blocks is collected and put in order
+	 * by reversing the chain and then each block.
+	 */
+	void find_runs()
+	{
+		std::size_t chunk = (n + threads - 1) / threads;
+		chunk = (chunk + minrun - 1) / minrun * minrun;
+		std::size_t num_chunks = (n + chunk - 1) / chunk;
+		std::vector<std::vector<std::size_t>> chunk_runs(num_chunks);
+		run_team(num_chunks, [&](std::size_t t){
+			std::size_t position = t * chunk;
+			std::size_t stop = std::min(n, position + chunk);
+			while(position < stop)
+			{
+				position = next_run(position, stop);
+				chunk_runs[t].push_back(position);
+			}
+		});
+		std::vector<std::size_t> chain;  // block boundaries, blocks in descending order
+		auto fix_chain = [&]{
+			std::reverse(start + chain.front(), start + chain.back());
+			std::size_t pos = chain.front();
+			for(std::size_t k = chain.size() - 1; k > 0; --k)
+			{
+				std::size_t len = chain[k] - chain[k - 1];
+				std::reverse(start + pos, start + pos + len);
+				pos += len;
+			}
+			chain.clear();
+		};
+		for(std::size_t t = 0; t < num_chunks; ++t)
+		{
+			// stitch the last run of the previous chunk and the first run of this chunk
+			if(t > 0)
+			{
+				std::size_t boundary = runs.back();
+				std::size_t first = runs.size() > 1 ? runs[runs.size() - 2] : 0;
+				std::size_t last = chunk_runs[t].front();
+				bool joined = false;
+				if(not chain.empty())
+				{
+					if(chain.back() == boundary
+					   and comp(start[last - 1], start[chain[chain.size() - 2]]))
+					{
+						chain.push_back(last);
+						joined = true;
+					}
+					else
+						fix_chain();
+				}
+				if(not joined)
+				{
+					if(not comp(start[boundary], start[boundary - 1]))
+						joined = true;
+					else if(comp(start[last - 1], start[first]))
+					{
+						chain = {first, boundary, last};
+						joined = true;
+					}
+				}
+				if(joined)
+					runs.pop_back();
+			}
+			runs.insert(runs.end(), chunk_runs[t].begin(), chunk_runs[t].end());
+		}
+		if(not chain.empty())
+			fix_chain();
+	}
+
+	/*
+	 * @brief Same as TimSort::push_next_run() within [position, stop), returns
+	 * the end of the run.
+	 */
+	std::size_t next_run(std::size_t position, std::size_t stop)
+	{
+		It first = start + position;
+		const std::size_t remain = stop - position;
+		if(remain <= 1)
+			return stop;
+		std::size_t idx = 2;
+		if(comp(first[1], first[0]))
+		{
+			while(idx < remain and comp(first[idx], first[idx - 1]))
+				++idx;
+			std::reverse(first, first + idx);
+		}
+		while(idx < remain and not comp(first[idx], first[idx - 1]))
+			++idx;
+		if(idx < remain and idx < minrun)
+		{
+			auto extend_to = std::min(minrun, remain);
+			finish_insertion_sort(first, first + idx, first + extend_to, comp);
+			idx = extend_to;
+		}
+		return position + idx;
+	}
+
+	/*
+	 * @brief Replays the merge pattern of the sequential timsort on the run
+	 * lengths and records the merges as a tree.
+	 */
+	void build_merge_tree()
+	{
+		nodes.reserve(2 * runs.size());
+		std::vector<std::size_t> stack;  // node indices
+		auto length = [&](std::size_t i){ return nodes[stack[stack.size() - 1 - i]].end
+		                                         - nodes[stack[stack.size() - 1 - i]].begin; };
+		// merge the Ith and (I+1)th node from the top of the stack
+		auto merge_at = [&](std::size_t i){
+			std::size_t r = stack[stack.size() - 1 - i];
+			std::size_t l = stack[stack.size() - 2 - i];
+			nodes.push_back(merge_node{nodes[l].begin, nodes[l].end, nodes[r].end,
+						   std::ptrdiff_t(l), std::ptrdiff_t(r)});
+			stack.erase(stack.end() - 2 - i);
+			stack[stack.size() - 1 - i] = nodes.size() - 1;
+		};
+		std::size_t begin = 0;
+		for(std::size_t end : runs)
+		{
+			// resolve the invariants (X > Y + Z, W > X + Y, Y > Z) before pushing
+			while(stack.size() > 1)
+			{
+				if((stack.size() > 2 and length(2) <= length(1) + length(0))
+				   or (stack.size() > 3 and length(3) <= length(2) + length(1)))
+				{
+					if(length(2) < length(0))
+						merge_at(1);
+					else
+						merge_at(0);
+				}
+				else if(length(1) <= length(0))
+					merge_at(0);
+				else
+					break;
+			}
+			nodes.push_back(merge_node{begin, end, end, -1, -1});
+			stack.push_back(nodes.size() - 1);
+			begin = end;
+		}
+		while(stack.size() > 1)
+			merge_at(0);
+	}
+
+	/*
+	 * @brief Executes the merges of the subtree of node with num_threads threads.
+	 */
+	void execute(std::size_t node, std::size_t num_threads, int depth)
+	{
+		const merge_node& m = nodes[node];
+		if(m.left < 0)
+			return;
+		if(num_threads <= 1)
+		{
+			// iterative post-order, the merge tree can be deep
+			std::vector<std::pair<std::size_t, bool>> todo{{node, false}};
+			while(not todo.empty())
+			{
+				auto [i, children_done] = todo.back();
+				todo.pop_back();
+				if(nodes[i].left < 0)
+					continue;
+				if(children_done)
+					merge_sequential(nodes[i]);
+				else
+				{
+					todo.emplace_back(i, true);
+					todo.emplace_back(nodes[i].right, false);
+					todo.emplace_back(nodes[i].left, false);
+				}
+			}
+			return;
+		}
+		std::size_t size = m.end - m.begin;
+		std::size_t lsize = m.mid - m.begin;
+		std::size_t rsize = m.end - m.mid;
+		if(depth < 64 and 2 * num_threads * lsize < size)
+		{
+			// the left subtree is small, do it first and give all threads to the right
+			execute(m.left, 1, depth + 1);
+			execute(m.right, num_threads, depth + 1);
+		}
+		else if(depth < 64 and 2 * num_threads * rsize < size)
+		{
+			execute(m.right, 1, depth + 1);
+			execute(m.left, num_threads, depth + 1);
+		}
+		else
+		{
+			// independent subtrees: split the threads proportional to size
+			std::size_t lthreads = (num_threads * lsize + size / 2) / size;
+			lthreads = std::min(std::max(lthreads, std::size_t(1)), num_threads - 1);
+			std::thread left_thread([&]{ execute(m.left, lthreads, depth + 1); });
+			execute(m.right, num_threads - lthreads, depth + 1);
+			left_thread.join();
+		}
+		merge_parallel(m, num_threads);
+	}
+
+	/*
+	 * @brief Merges [begin, mid) with [mid, end) copying the smaller side into
+	 * the buffer (at the same offsets), like TimSort::merge_runs().
+	 */
+	void merge_sequential(const merge_node& m)
+	{
+		It begin = start + m.begin;
+		It mid = start + m.mid;
+		It end = start + m.end;
+		begin = gallop_upper_bound(begin, mid, *mid, comp);
+		end = gallop_upper_bound(std::make_reverse_iterator(end),
+					 std::make_reverse_iterator(mid),
+					 mid[-1],
+					 [comp=this->comp](auto&& a, auto&& b){ return comp(b, a); }).base();
+		if(not (begin < mid and mid < end))
+			return;
+		value_type* buf = buffer.data() + (begin - start);
+		if((end - mid) >= (mid - begin))
+		{
+			std::copy(begin, mid, buf);
+			gallop_merge_into<true>(buf, buf + (mid - begin), mid, end, begin, comp);
+		}
+		else
+		{
+			std::copy(mid, end, buf);
+			gallop_merge_into<true>(std::make_reverse_iterator(buf + (end - mid)),
+						std::make_reverse_iterator(buf),
+						std::make_reverse_iterator(mid),
+						std::make_reverse_iterator(begin),
+						std::make_reverse_iterator(end),
+						[comp=this->comp](auto&& a, auto&& b){ return comp(b, a); });
+		}
+	}
+
+	/*
+	 * @brief Stable co-rank: the number i of elements taken from [a, a + la)
+	 * among the first k elements of the merge of [a, a + la) and [b, b + lb).
+	 */
+	std::size_t co_rank(std::size_t k, It a, std::size_t la, It b, std::size_t lb) const
+	{
+		std::size_t lo = k > lb ? k - lb : 0;
+		std::size_t hi = std::min(k, la);
+		while(lo < hi)
+		{
+			std::size_t i = lo + (hi - lo) / 2;
+			std::size_t j = k - i;
+			// a[i] precedes b[j - 1] (ties favour the left): need more from a
+			if(j > 0 and not comp(b[j - 1], a[i]))
+				lo = i + 1;
+			else
+				hi = i;
+		}
+		return lo;
+	}
+
+	/*
+	 * @brief Merges [begin, mid) with [mid, end) with num_threads threads.  The
+	 * output is cut into equal pieces at co-ranks, each thread copies the
+	 * sources of its piece into the buffer and merges them back with galloping.
+	 */
+	void merge_parallel(const merge_node& m, std::size_t num_threads)
+	{
+		It begin = start + m.begin;
+		It mid = start + m.mid;
+		It end = start + m.end;
+		begin = gallop_upper_bound(begin, mid, *mid, comp);
+		end = gallop_upper_bound(std::make_reverse_iterator(end),
+					 std::make_reverse_iterator(mid),
+					 mid[-1],
+					 [comp=this->comp](auto&& a, auto&& b){ return comp(b, a); }).base();
+		if(not (begin < mid and mid < end))
+			return;
+		std::size_t la = mid - begin, lb = end - mid, len = la + lb;
+		num_threads = std::min(num_threads, len / merge_grain);
+		if(num_threads <= 1)
+		{
+			merge_sequential(merge_node{std::size_t(begin - start), m.mid,
+						    std::size_t(end - start), 0, 0});
+			return;
+		}
+		std::vector<std::size_t> split(num_threads + 1);
+		split[num_threads] = la;
+		run_team(num_threads, [&](std::size_t t){
+			if(t > 0)
+				split[t] = co_rank(len * t / num_threads, begin, la, mid, lb);
+		});
+		value_type* buf = buffer.data() + (begin - start);
+		// copy the sources of all pieces before any piece is overwritten
+		run_team(num_threads, [&](std::size_t t){
+			std::size_t k0 = len * t / num_threads, k1 = len * (t + 1) / num_threads;
+			std::size_t i0 = split[t], i1 = split[t + 1];
+			std::copy(begin + i0, begin + i1, buf + i0);
+			std::copy(mid + (k0 - i0), mid + (k1 - i1), buf + la + (k0 - i0));
+		});
+		run_team(num_threads, [&](std::size_t t){
+			std::size_t k0 = len * t / num_threads, k1 = len * (t + 1) / num_threads;
+			std::size_t i0 = split[t], i1 = split[t + 1];
+			gallop_merge_into<false>(buf + i0, buf + i1,
+						 buf + la + (k0 - i0), buf + la + (k1 - i1),
+						 begin + k0, comp);
+		});
+	}
+
+	const It start;
+	Comp comp;
+	const std::size_t n;
+	const std::size_t threads;
+	const std::size_t minrun;
+	/** End offsets of the runs. */
+	std::vector<std::size_t> runs;
+	/** Merge tree, children precede their parents, the root is last. */
+	std::vector<merge_node> nodes;
+	/** Merge buffer of n elements, a merge of [begin, end) uses the same offsets. */
+	greensort_buffer<value_type> buffer;
+};
+
+} /* namespace parallel */
+
+} /* namespace internal */
+
+
+template <class It, class Comp>
+void timsort_parallel(It begin, It end, Comp comp, std::size_t num_threads = 0)
+{
+	using value_type = internal::iterator_value_type_t<It>;
+	if(num_threads == 0)
+		num_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::size_t len = end - begin;
+	if constexpr(std::is_trivially_copyable_v<value_type>)
+	{
+		if(num_threads > 1 and len >= internal::parallel::sequential_threshold)
+		{
+			internal::parallel::ParallelTimSort<It, Comp>(begin, end, comp, num_threads);
+			return;
+		}
+	}
+	timsort(begin, end, comp);
+}
+
+template <class It>
+void timsort_parallel(It begin, It end, std::size_t num_threads = 0)
+{
+	timsort_parallel(begin, end, tim::internal::DefaultComparator{}, num_threads);
+}
+
+} /* namespace tim */
+
+#endif /* TIMSORT_PARALLEL_H */
@@ -1,5 +1,14 @@
-#ifndef TIMSORT_H
-#define TIMSORT_H
+#ifndef TIMSORT_PREALLOCATED_H
+#define TIMSORT_PREALLOCATED_H
+
+/*
+ * Variant of timsort.h with a merge buffer allocated before sorting: the
+ * caller passes scratch space of at least n/2 elements (or the scratch is
+ * taken from the package buffer cache), merges never allocate.  The largest
+ * number of elements buffered by a merge (on the run stack or in the scratch)
+ * is reported.  Lives in tim::internal::preallocated such that it can be used
+ * together with timsort.h.
+ */
 
 #include <algorithm>
 #include <cstddef>
@@ -8,15 +17,20 @@
 #include <functional>
 #include <vector>
 #include <limits>
+#include <stdexcept>
+#include <type_traits>
 #include "utils.h"
 #include "timsort_stack_buffer.h"
 #include "minrun.h"
 #include "compiler.h"
+#include "../buffer_cache.h"
 
 namespace tim {
 
 namespace internal {
 
+namespace preallocated {
+
 template <class It,
 	  class Comp>
 struct TimSort
@@ -28,9 +42,11 @@ struct TimSort
 	 * @param comp_func  Comparator to use.
 	 */ 
 	using value_type = iterator_value_type_t<It>;
-	TimSort(It begin_it, It end_it, Comp comp_func):
+	static_assert(std::is_trivially_copyable_v<value_type>,
+		      "the preallocated scratch needs trivially copyable elements");
+	TimSort(It begin_it, It end_it, Comp comp_func, value_type* scratch_mem):
 		stack_buffer{},
-		heap_buffer{},
+		scratch(scratch_mem),
 		start(begin_it), 
 		stop(end_it),
 		position(begin_it),
@@ -38,11 +54,9 @@ struct TimSort
 		minrun(compute_minrun<value_type>(end_it - begin_it)),
 		min_gallop(default_min_gallop)
 	{
-		// try_get_cached_heap_buffer(heap_buffer);
+		// the scratch of (stop - start) / 2 elements is allocated by the caller
 		fill_run_stack();
 		collapse_run_stack();
-		heap_buffer.reserve((stop - start)/2 + 1);
-		// try_cache_heap_buffer(heap_buffer);
 	}
 	
 	
@@ -293,6 +307,7 @@ struct TimSort
 	template <class Iter, class Cmp>
 	void do_merge(Iter begin, Iter mid, Iter end, Cmp cmp)
 	{
+		max_buffered = std::max(max_buffered, std::size_t(mid - begin));
 		// check to see if we can use the run stack as a temporary buffer
 		if(stack_buffer.can_acquire_merge_buffer(begin, mid)) 
 		{
@@ -304,15 +319,26 @@ struct TimSort
 		}
 		else
 		{
-			// TODO: clean this up
-			// fall back to a std::vector<> for the merge buffer 
-			// try to use memcpy if possible
-			// 
-			// bypass speculative overallocation of std::vector.
-			// this measurably improves benchmarks for all cases.
-			heap_buffer.reserve(mid - begin);
-			heap_buffer.assign(std::make_move_iterator(begin), std::make_move_iterator(mid));
-			gallop_merge(heap_buffer.begin(), heap_buffer.end(), mid, end, begin, cmp);
+			// the smaller run has at most (stop - start) / 2 elements and
+			// fits into the preallocated scratch, use memcpy if possible
+			if constexpr(can_forward_memcpy_v<Iter> or not can_reverse_memcpy_v<Iter>)
+			{
+				if constexpr (can_forward_memcpy_v<Iter>)
+					std::memcpy(scratch, get_memcpy_iterator(begin), (mid - begin) * sizeof(value_type));
+				else
+					std::copy(begin, mid, scratch);
+				gallop_merge(scratch, scratch + (mid - begin),
+							     mid, end, 
+							     begin, cmp);
+			}
+			else
+			{
+				std::memcpy(scratch, get_memcpy_iterator(mid - 1), (mid - begin) * sizeof(value_type));
+				gallop_merge(std::make_reverse_iterator(scratch + (mid - begin)),
+					     std::make_reverse_iterator(scratch),
+					     mid, end, 
+					     begin, cmp);
+			}
 		}
 	}
 
@@ -491,8 +517,10 @@ struct TimSort
 	 * Empty stack space is used for merge buffer when possible.
 	 */
 	timsort_stack_buffer<std::size_t, value_type> stack_buffer; 
-	/** Fallback heap-allocated array used for merge buffer. */
-	std::vector<value_type> heap_buffer;
+	/** Preallocated merge buffer of at least (stop - start) / 2 elements. */
+	value_type* const scratch;
+	/** Largest number of elements buffered by a merge. */
+	std::size_t max_buffered = 0;
 	/** 'begin' iterator to the range being sorted. */
 	const It start;
 	/** 'end' iterator to the range being sorted. */
@@ -522,30 +550,50 @@ struct TimSort
 
 
 template <class It, class Comp>
-static void _timsort(It begin, It end, Comp comp)
+static std::size_t _timsort(It begin, It end, Comp comp, iterator_value_type_t<It>* scratch)
 {
 	using value_type = iterator_value_type_t<It>;
 	std::size_t len = end - begin;
 	if(len > max_minrun<value_type>())
-		TimSort<It, Comp>(begin, end, comp);
-	else
-		finish_insertion_sort(begin, begin + (end > begin), end, comp);
+		return TimSort<It, Comp>(begin, end, comp, scratch).max_buffered;
+	finish_insertion_sort(begin, begin + (end > begin), end, comp);
+	return 0;
 }
  
+} /* namespace preallocated */
+
 } /* namespace internal */
 
 
+/*
+ * @brief Timsort without allocations during merging.
+ * @param scratch       Merge buffer of scratch_size >= (end - begin) / 2 elements,
+ *                      if nullptr it is taken from the package buffer cache.
+ * @returns the largest number of elements buffered by a merge.
+ */
 template <class It, class Comp>
-void timsort(It begin, It end, Comp comp)
+std::size_t timsort_preallocated(It begin, It end, Comp comp,
+				 internal::iterator_value_type_t<It>* scratch = nullptr,
+				 std::size_t scratch_size = 0)
 {
-	internal::_timsort(begin, end, comp);
+	using value_type = internal::iterator_value_type_t<It>;
+	std::size_t need = (end - begin) / 2;
+	if(scratch)
+	{
+		if(scratch_size < need)
+			throw std::length_error("timsort_preallocated: scratch smaller than half the range");
+		return internal::preallocated::_timsort(begin, end, comp, scratch);
+	}
+	greensort_buffer<value_type> arena;
+	arena.resize(need);
+	return internal::preallocated::_timsort(begin, end, comp, arena.data());
 }
 
 
 template <class It>
-void timsort(It begin, It end)
+std::size_t timsort_preallocated(It begin, It end)
 {
-	timsort(begin, end, tim::internal::DefaultComparator{}); 
+	return timsort_preallocated(begin, end, tim::internal::DefaultComparator{}); 
 }
 
 
@@ -555,4 +603,4 @@ void timsort(It begin, It end)
 
 #include "undef_compiler.h"
 
-#endif /* TIMSORT_H */
+#endif /* TIMSORT_PREALLOCATED_H */
@@ -1,5 +1,4 @@
-#ifndef TIMSORT_UNDEF_COMPILER_H
-#define TIMSORT_UNDEF_COMPILER_H
+// No include guard, see compiler.h
 
 
 #ifdef 	COMPILER_LIKELY_ 
@@ -19,4 +18,3 @@
 #endif
 
 
-#endif /* TIMSORT_UNDEF_COMPILER_H */